@@ -0,0 +1,119 @@
+//batch_bench.cpp
+
+// Throughput and accuracy of the batch elementary functions of omni::batch
+// (see include/omniunit/batch.hh).
+//
+// For every function, 2^20 dimensionless units spread over the domain of its kernel
+// go through a scalar loop on the functions of Unit.hh (std:: functions of the
+// counts) and through omni::batch. The best time of several runs (in nanoseconds per
+// element) of both, and the largest distance in ulps between their results, are
+// printed. sin is also run on degrees, whose conversion is done by the batch.
+//
+// usage :
+//   make batch-bench
+
+#include "omniunit/omniunit.hh"
+#include "omniunit/batch.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+constexpr std::size_t size = std::size_t(1) << 20;
+constexpr int runs = 10;
+
+volatile double sink = 0.;
+
+
+template <typename function_t>
+double best_time(function_t&& function)
+{
+  double best = 1e300;
+  for(int i = 0; i < runs; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / static_cast<double>(size));
+  }
+  return best;
+}
+
+
+double max_ulp(std::vector<double> const& a, std::vector<double> const& b)
+{
+  double worst = 0.;
+  for(std::size_t i = 0; i < a.size(); i++)
+  {
+    std::int64_t bitsA = 0;
+    std::int64_t bitsB = 0;
+    std::memcpy(&bitsA, &a[i], sizeof(double));
+    std::memcpy(&bitsB, &b[i], sizeof(double));
+    worst = std::max(worst, std::fabs(static_cast<double>(bitsA - bitsB)));
+  }
+  return worst;
+}
+
+
+template <typename unit_t, typename scalar_t, typename batch_t>
+void run(char const* name, double low, double high, scalar_t&& scalar, batch_t&& batch)
+{
+  std::mt19937_64 generator(42);
+  std::uniform_real_distribution<double> distribution(low, high);
+  std::vector<unit_t> values(size);
+  for(unit_t& value : values)
+    value = unit_t(distribution(generator));
+
+  std::vector<double> scalarResults(size);
+  std::vector<double> batchResults(size);
+  double scalarTime = best_time([&]
+  {
+    for(std::size_t i = 0; i < size; i++)
+      scalarResults[i] = scalar(values[i]);
+    sink = sink + scalarResults[size / 2];
+  });
+  double batchTime = best_time([&]
+  {
+    batch(values, batchResults);
+    sink = sink + batchResults[size / 2];
+  });
+
+  std::printf("%-12s %16.3f %16.3f %10.2f %10.0f\n", name, scalarTime, batchTime, scalarTime / batchTime, max_ulp(scalarResults, batchResults));
+}
+
+
+int main()
+{
+  std::printf("%-12s %16s %16s %10s %10s\n", "function", "scalar (ns)", "batch (ns)", "speedup", "max ulp");
+
+  run<omni::radian<>>("sin", -10., 10., [](omni::radian<> x) {return omni::sin(x);},
+                      [](auto const& in, auto& out) {omni::batch::sin(in, out);});
+  run<omni::radian<>>("sin 8e5", -8e5, 8e5, [](omni::radian<> x) {return omni::sin(x);},
+                      [](auto const& in, auto& out) {omni::batch::sin(in, out);});
+  run<omni::degree<>>("sin (deg)", -3600., 3600., [](omni::degree<> x) {return omni::sin(x);},
+                      [](auto const& in, auto& out) {omni::batch::sin(in, out);});
+  run<omni::radian<>>("cos", -10., 10., [](omni::radian<> x) {return omni::cos(x);},
+                      [](auto const& in, auto& out) {omni::batch::cos(in, out);});
+  run<omni::radian<>>("tan", -10., 10., [](omni::radian<> x) {return omni::tan(x);},
+                      [](auto const& in, auto& out) {omni::batch::tan(in, out);});
+  run<omni::value<>>("atan", -100., 100., [](omni::value<> x) {return omni::atan(x);},
+                     [](auto const& in, auto& out) {omni::batch::atan(in, out);});
+  run<omni::value<>>("exp", -700., 700., [](omni::value<> x) {return omni::exp(x);},
+                     [](auto const& in, auto& out) {omni::batch::exp(in, out);});
+  run<omni::value<>>("log", 1e-3, 1e6, [](omni::value<> x) {return omni::log(x);},
+                     [](auto const& in, auto& out) {omni::batch::log(in, out);});
+  run<omni::value<>>("sinh", -700., 700., [](omni::value<> x) {return omni::sinh(x);},
+                     [](auto const& in, auto& out) {omni::batch::sinh(in, out);});
+  run<omni::value<>>("cosh", -700., 700., [](omni::value<> x) {return omni::cosh(x);},
+                     [](auto const& in, auto& out) {omni::batch::cosh(in, out);});
+  run<omni::value<>>("tanh", -20., 20., [](omni::value<> x) {return omni::tanh(x);},
+                     [](auto const& in, auto& out) {omni::batch::tanh(in, out);});
+
+  return 0;
+}
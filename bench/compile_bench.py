@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+#compile_bench.py
+
+# Compile-time benchmark for OmniUnit.
+#
+# For every (N, M) case, a translation unit instantiating N distinct unit
+# types and M mixed-unit expressions is generated, then compiled once with
+# -ftime-report. Wall time, peak compiler RSS, object size and the GCC phase
+# timings are written to a JSON file which can be compared against a stored
+# baseline. The size of the code (.text sections) and the number of functions
+# emitted in each object are recorded as well : with --flags "-std=c++17 -Os"
+# this is the binary-size benchmark (make size-bench).
+#
+# usage :
+#   python3 bench/compile_bench.py [--sizes 10,100,1000,5000] [--grid]
+#                                  [--baseline FILE] [--output FILE]
+#                                  [--max-regression PERCENT]
+
+import argparse
+import json
+import os
+import platform
+import re
+import shlex
+import subprocess
+import sys
+import time
+
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# a unit type is a (dimension, prefix) pair : prefixes are the outer loop so
+# that consecutive units share a dimension and can be added together
+PREFIXES = ["nano", "micro", "milli", "centi", "deci", "base", "kilo", "mega"]
+EXPONENTS = range(-4, 5)
+
+PHASE_LINE = re.compile(r"^\s*(phase [^:]*?|TOTAL)\s*:\s*([0-9.]+)\s*(?:\([^)]*\))?\s*([0-9.]+)\s*(?:\([^)]*\))?\s*([0-9.]+)")
+
+
+
+def dimension(index):
+  # walk through length/mass/time/current exponents in [-4, 4]
+  exps = []
+  for _ in range(4):
+    exps.append(EXPONENTS[index % len(EXPONENTS)])
+    index //= len(EXPONENTS)
+  return "omni::Dimension<{},{},{},{},0,0,0>".format(*exps)
+
+
+def generate(n, m):
+  p = len(PREFIXES)
+  lines = ['#include "omniunit/omniunit.hh"', ""]
+
+  for i in range(n):
+    lines.append("typedef omni::Unit<{}, double, omni::{}, omni::zero> u{};"
+      .format(dimension(i // p), PREFIXES[i % p], i))
+  lines.append("")
+
+  # each expression adds two units of the same dimension and multiplies /
+  # divides the result by two units of other dimensions
+  per_function = 100
+  for f in range(0, m, per_function):
+    lines.append("double expressions{}(double x)".format(f // per_function))
+    lines.append("{")
+    lines.append("  double r = 0;")
+    for j in range(f, min(m, f + per_function)):
+      group = (j % max(1, n // p)) * p
+      a = min(n - 1, group + j % p)
+      b = min(n - 1, group + (j + 3) % p)
+      c = (j * 7 + 1) % n
+      d = (j * 13 + 5) % n
+      lines.append("  r += ((u{a}(x) + u{b}(x)) * u{c}(x) / u{d}(x)).count();"
+        .format(a=a, b=b, c=c, d=d))
+    lines.append("  return r;")
+    lines.append("}")
+    lines.append("")
+
+  return "\n".join(lines) + "\n"
+
+
+def parse_time_report(text):
+  phases = {}
+  for line in text.splitlines():
+    match = PHASE_LINE.match(line)
+    if match:
+      name = match.group(1).strip()
+      phases[name] = {"usr": float(match.group(2)), "sys": float(match.group(3)), "wall": float(match.group(4))}
+  return phases
+
+
+def code_size(obj):
+  # every section starting with .text (-ffunction-sections gives one per function)
+  text = 0
+  out = subprocess.run(["size", "-A", obj], capture_output=True, text=True, check=True).stdout
+  for line in out.splitlines():
+    cells = line.split()
+    if len(cells) >= 2 and cells[0].startswith(".text"):
+      text += int(cells[1])
+
+  # defined functions, weak ones included (template instantiations are weak)
+  out = subprocess.run(["nm", "--defined-only", obj], capture_output=True, text=True, check=True).stdout
+  functions = sum(1 for line in out.splitlines() if len(line.split()) == 3 and line.split()[1] in "TtWw")
+  return text, functions
+
+
+def compile_case(cxx, flags, workdir, n, m):
+  source = os.path.join(workdir, "tu_{}_{}.cpp".format(n, m))
+  obj = os.path.join(workdir, "tu_{}_{}.o".format(n, m))
+  report = os.path.join(workdir, "tu_{}_{}.time-report.txt".format(n, m))
+
+  with open(source, "w") as f:
+    f.write(generate(n, m))
+
+  cmd = [cxx] + flags + ["-I", os.path.join(ROOT, "include"), "-ftime-report", "-c", source, "-o", obj]
+  with open(report, "w") as err:
+    begin = time.monotonic()
+    proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=err)
+    # wait4 gives the rusage of this compilation only (cc1plus included),
+    # which RUSAGE_CHILDREN cannot since it accumulates over all cases
+    _, status, usage = os.wait4(proc.pid, 0)
+    wall = time.monotonic() - begin
+    proc.returncode = os.waitstatus_to_exitcode(status)
+
+  with open(report) as f:
+    text = f.read()
+  if proc.returncode != 0:
+    sys.stderr.write(text)
+    raise RuntimeError("compilation failed for N={} M={}".format(n, m))
+
+  # ru_maxrss is in kilobytes on Linux, in bytes on macOS
+  rss = usage.ru_maxrss if sys.platform != "darwin" else usage.ru_maxrss // 1024
+
+  text_size, functions = code_size(obj)
+
+  return {
+    "n": n,
+    "m": m,
+    "wall_s": round(wall, 3),
+    "peak_rss_kb": rss,
+    "object_bytes": os.path.getsize(obj),
+    "text_bytes": text_size,
+    "functions": functions,
+    "phases": parse_time_report(text),
+    "time_report": os.path.relpath(report, ROOT),
+  }
+
+
+def compare(results, baseline, max_regression):
+  old = {(c["n"], c["m"]): c for c in baseline["cases"]}
+  worst = 0.
+  print("\n{:>6} {:>6} {:>12} {:>12} {:>12} {:>12} {:>12}".format("N", "M", "wall", "peak RSS", "object", "text", "functions"))
+  for case in results["cases"]:
+    ref = old.get((case["n"], case["m"]))
+    if ref is None:
+      continue
+    cells = []
+    for key in ("wall_s", "peak_rss_kb", "object_bytes", "text_bytes", "functions"):
+      if key not in ref:
+        cells.append("-")
+        continue
+      delta = 100. * (case[key] - ref[key]) / ref[key] if ref[key] else 0.
+      worst = max(worst, delta)
+      cells.append("{:+.1f}%".format(delta))
+    print("{:>6} {:>6} {:>12} {:>12} {:>12} {:>12} {:>12}".format(case["n"], case["m"], *cells))
+  if max_regression is not None and worst > max_regression:
+    print("\nregression of {:.1f}% exceeds the allowed {:.1f}%".format(worst, max_regression))
+    return 1
+  return 0
+
+
+def main():
+  parser = argparse.ArgumentParser(description="OmniUnit compile-time benchmark")
+  parser.add_argument("--sizes", default="10,100,1000,5000",
+    help="comma separated values used for both N (unit types) and M (expressions)")
+  parser.add_argument("--grid", action="store_true",
+    help="benchmark every (N, M) pair instead of N == M only")
+  parser.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+  parser.add_argument("--flags", default="-std=c++17 -O0",
+    help="compiler flags used for every case")
+  parser.add_argument("--workdir", default=os.path.join(ROOT, "bench", "out"))
+  parser.add_argument("--output", default=None,
+    help="JSON result file (default : <workdir>/compile_bench.json)")
+  parser.add_argument("--baseline", default=os.path.join(ROOT, "bench", "compile_baseline.json"),
+    help="JSON file to compare against, ignored if missing")
+  parser.add_argument("--max-regression", type=float, default=None,
+    help="exit with an error if any metric grows by more than this percentage")
+  args = parser.parse_args()
+
+  sizes = [int(s) for s in args.sizes.split(",") if s]
+  cases = [(n, m) for n in sizes for m in sizes] if args.grid else [(s, s) for s in sizes]
+  flags = shlex.split(args.flags)
+  os.makedirs(args.workdir, exist_ok=True)
+
+  version = subprocess.run([args.cxx, "--version"], capture_output=True, text=True).stdout.splitlines()[0]
+  results = {"compiler": version, "flags": args.flags, "machine": platform.machine(), "cases": []}
+
+  print("{:>6} {:>6} {:>10} {:>14} {:>14} {:>12} {:>10}".format("N", "M", "wall (s)", "peak RSS (kB)", "object (B)", "text (B)", "functions"))
+  for n, m in cases:
+    case = compile_case(args.cxx, flags, args.workdir, n, m)
+    results["cases"].append(case)
+    print("{:>6} {:>6} {:>10.3f} {:>14} {:>14} {:>12} {:>10}".format(n, m, case["wall_s"], case["peak_rss_kb"], case["object_bytes"],
+      case["text_bytes"], case["functions"]))
+
+  output = args.output or os.path.join(args.workdir, "compile_bench.json")
+  with open(output, "w") as f:
+    json.dump(results, f, indent=2)
+  print("\nresults written to " + os.path.relpath(output, ROOT))
+
+  if os.path.isfile(args.baseline):
+    with open(args.baseline) as f:
+      return compare(results, json.load(f), args.max_regression)
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
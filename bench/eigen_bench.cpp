@@ -0,0 +1,99 @@
+//eigen_bench.cpp
+
+// Runtime benchmark of Eigen matrices of units (see include/omniunit/eigen.hh).
+//
+// The covariance prediction of a Kalman filter, P = F * P * F^T + Q, is computed for
+// N = 12 and N = 30 states with raw double matrices, with Eigen::Matrix<omni::meter<>>
+// (NumTraits, element by element, with lazyProduct) and with omni::UnitMatrix<omni::meter<>> (counts in
+// a double matrix). The best time of several runs is printed in nanoseconds per
+// prediction.
+//
+// usage :
+//   make eigen-bench
+
+#include "omniunit/omniunit.hh"
+#include "omniunit/eigen.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+
+constexpr int iterations = 2000;
+constexpr int runs = 20;
+
+volatile double sink = 0.;
+
+
+template <typename function_t>
+double best_time(function_t&& function)
+{
+  double best = 1e300;
+  for(int i = 0; i < runs; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for(int j = 0; j < iterations; ++j)
+      function();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / iterations);
+  }
+  return best;
+}
+
+
+template <int N>
+void bench(std::mt19937_64& generator)
+{
+  std::uniform_real_distribution<double> distribution(-1., 1.);
+  typedef Eigen::Matrix<double, N, N> raw_t;
+  raw_t F = raw_t::Identity() + 0.01 * raw_t::NullaryExpr([&](){return distribution(generator);});
+  raw_t P0 = raw_t::NullaryExpr([&](){return distribution(generator);});
+  P0 = (P0 * P0.transpose()).eval();
+  raw_t Q = 0.001 * raw_t::Identity();
+
+  //the iterations are chained so that nothing is hoisted ; F is close to the identity
+  raw_t P = P0;
+  double raw = best_time([&]
+  {
+    P = F * P * F.transpose() + Q;
+    P *= 0.5;
+    sink = sink + P(0, 0);
+  });
+
+  typedef Eigen::Matrix<omni::value<>, N, N> scale_t;
+  typedef Eigen::Matrix<omni::meter<>, N, N> unit_t;
+  scale_t uF = F.unaryExpr([](double x){return omni::value<>(x);});
+  unit_t uQ = Q.unaryExpr([](double x){return omni::meter<>(x);});
+  unit_t uP = P0.unaryExpr([](double x){return omni::meter<>(x);});
+  double numTraits = best_time([&]
+  {
+    uP = uF.lazyProduct(uP).eval().lazyProduct(uF.transpose()).template cast<omni::meter<>>() + uQ;
+    uP = uP * 0.5;
+    sink = sink + uP(0, 0).count();
+  });
+
+  omni::UnitMatrix<omni::value<>, N, N> mF(F);
+  omni::UnitMatrix<omni::meter<>, N, N> mQ(Q);
+  omni::UnitMatrix<omni::meter<>, N, N> mP(P0);
+  double unitMatrix = best_time([&]
+  {
+    mP = mF * mP * mF.transpose() + mQ;
+    mP *= 0.5;
+    sink = sink + mP(0, 0).count();
+  });
+
+  std::printf("%-6d %14.1f %22.1f %22.1f\n", N, raw, numTraits, unitMatrix);
+}
+
+
+int main()
+{
+  std::mt19937_64 generator(42);
+
+  std::printf("%-6s %14s %22s %22s   (ns per prediction)\n", "N", "double", "Matrix<meter<>>", "UnitMatrix<meter<>>");
+  bench<12>(generator);
+  bench<30>(generator);
+
+  return 0;
+}
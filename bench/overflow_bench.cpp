@@ -0,0 +1,116 @@
+//overflow_bench.cpp
+
+// Runtime benchmark of the overflow policies of integer representations.
+//
+// For every representation (plain std::int64_t without unit, meter<std::int64_t>,
+// checked<>, saturating<> and wrapping<>), an array of counts is converted from
+// kilometers to millimeters (unit_cast, a multiplication by 10^6) and summed
+// (operator+=). The best time of several runs is printed in nanoseconds per element.
+// No value overflows : this is the price of the detection alone.
+//
+// usage :
+//   make overflow-bench
+
+#include "omniunit/omniunit.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+constexpr std::size_t size = 1 << 16;
+constexpr int runs = 50;
+
+volatile std::int64_t sink = 0;
+
+
+template <typename function_t>
+double best_time(function_t&& function)
+{
+  double best = 1e300;
+  for(int i = 0; i < runs; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / static_cast<double>(size));
+  }
+  return best;
+}
+
+
+template <typename Rep>
+std::int64_t raw(Rep const& count)
+{
+  return static_cast<std::int64_t>(count);
+}
+
+
+template <typename T, omni::Overflow policy>
+std::int64_t raw(omni::Integer<T, policy> const& count)
+{
+  return count.value();
+}
+
+
+template <typename Rep>
+void bench_units(char const* name, std::vector<std::int64_t> const& counts)
+{
+  std::vector<omni::kilometer<Rep>> in(counts.begin(), counts.end());
+  std::vector<omni::millimeter<Rep>> out(size);
+
+  double cast = best_time([&]
+  {
+    for(std::size_t i = 0; i < size; ++i)
+      out[i] = omni::unit_cast<omni::millimeter<Rep>>(in[i]);
+    sink = sink + raw(out[size / 2].count());
+  });
+
+  double sum = best_time([&]
+  {
+    omni::millimeter<Rep> total(0);
+    for(std::size_t i = 0; i < size; ++i)
+      total += out[i];
+    sink = sink + raw(total.count());
+  });
+
+  std::printf("%-24s %10.3f %10.3f\n", name, cast, sum);
+}
+
+
+int main()
+{
+  std::mt19937_64 generator(42);
+  std::uniform_int_distribution<std::int64_t> distribution(-1000000, 1000000);
+  std::vector<std::int64_t> counts(size);
+  for(std::int64_t& count : counts)
+    count = distribution(generator);
+
+  std::printf("%-24s %10s %10s   (ns per element)\n", "representation", "km to mm", "sum");
+
+  std::vector<std::int64_t> out(size);
+  double cast = best_time([&]
+  {
+    for(std::size_t i = 0; i < size; ++i)
+      out[i] = counts[i] * 1000000;
+    sink = sink + out[size / 2];
+  });
+  double sum = best_time([&]
+  {
+    std::int64_t total = 0;
+    for(std::size_t i = 0; i < size; ++i)
+      total += out[i];
+    sink = sink + total;
+  });
+  std::printf("%-24s %10.3f %10.3f\n", "int64_t (no unit)", cast, sum);
+
+  bench_units<std::int64_t>("meter<int64_t>", counts);
+  bench_units<omni::checked<std::int64_t>>("checked<int64_t>", counts);
+  bench_units<omni::saturating<std::int64_t>>("saturating<int64_t>", counts);
+  bench_units<omni::wrapping<std::int64_t>>("wrapping<int64_t>", counts);
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+//parallel_bench.cpp
+
+// Throughput of the parallel algorithms of omni::parallel
+// (see include/omniunit/parallel.hh) against plain loops.
+//
+// 2^24 lengths and durations give speeds (transform) and a sum of
+// length.duration products (transform_reduce). The best time of several runs,
+// in nanoseconds per element, is printed for a plain loop and for pools of
+// 1 thread, of all hardware threads, and of all hardware threads bound to cores.
+//
+// usage :
+//   make parallel-bench
+
+#include "omniunit/omniunit.hh"
+#include "omniunit/parallel.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+constexpr std::size_t size = std::size_t(1) << 24;
+constexpr int runs = 10;
+
+volatile double sink = 0.;
+
+typedef omni::Unit<omni::Dimension<1,0,-1,0,0,0,0>, double, omni::base, omni::zero> speed;
+typedef omni::Unit<omni::Dimension<1,0,1,0,0,0,0>, double, omni::base, omni::zero> absement;
+
+
+template <typename function_t>
+double best_time(function_t&& function)
+{
+  double best = 1e300;
+  for(int i = 0; i < runs; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / static_cast<double>(size));
+  }
+  return best;
+}
+
+
+int main()
+{
+  std::mt19937_64 generator(42);
+  std::uniform_real_distribution<double> distribution(1., 2.);
+  std::vector<omni::meter<>> lengths(size);
+  std::vector<omni::second<>> durations(size);
+  std::vector<speed> speeds(size);
+  for(std::size_t i = 0; i < size; i++)
+  {
+    lengths[i] = omni::meter<>(distribution(generator));
+    durations[i] = omni::second<>(distribution(generator));
+  }
+
+  auto divide = [](omni::meter<> const& length, omni::second<> const& duration) {return length / duration;};
+
+  std::printf("%-28s %16s %22s\n", "", "transform (ns)", "transform_reduce (ns)");
+
+  double transformTime = best_time([&]
+  {
+    for(std::size_t i = 0; i < size; i++)
+      speeds[i] = divide(lengths[i], durations[i]);
+    sink = sink + speeds[size / 2].count();
+  });
+  double reduceTime = best_time([&]
+  {
+    absement total(0.);
+    for(std::size_t i = 0; i < size; i++)
+      total += lengths[i] * durations[i];
+    sink = sink + total.count();
+  });
+  std::printf("%-28s %16.3f %22.3f\n", "plain loop", transformTime, reduceTime);
+
+  unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+  omni::parallel::ThreadPool single(1);
+  omni::parallel::ThreadPool all(hardware);
+  omni::parallel::ThreadPool pinned(hardware, true);
+  struct
+  {
+    char const* name;
+    omni::parallel::ThreadPool& pool;
+  } const pools[] = {{"pool of 1 thread", single}, {"pool of all threads", all}, {"pool of all threads, pinned", pinned}};
+
+  for(auto const& entry : pools)
+  {
+    transformTime = best_time([&]
+    {
+      omni::parallel::transform(lengths, durations, speeds, divide, entry.pool);
+      sink = sink + speeds[size / 2].count();
+    });
+    reduceTime = best_time([&]
+    {
+      sink = sink + omni::parallel::transform_reduce(lengths, durations, absement(0.), std::plus<>(), std::multiplies<>(), entry.pool).count();
+    });
+    std::printf("%-28s %16.3f %22.3f\n", entry.name, transformTime, reduceTime);
+  }
+
+  return 0;
+}
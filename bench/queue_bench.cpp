@@ -0,0 +1,86 @@
+//queue_bench.cpp
+
+// Throughput of the sample queues of include/omniunit/queue.hh.
+//
+// Producers push 2^22 samples of omni::millibar<float>, timed in
+// omni::nanosecond<std::int64_t>, and the consumer pops them into
+// omni::second<double> and omni::pascal_t<double> : one by one, and in batches of
+// 4096 converted in bulk. The best time of several runs is printed in nanoseconds
+// per sample, for an spsc_queue with 1 producer and for an mpsc_queue with one
+// producer per hardware thread (at least 2).
+//
+// usage :
+//   make queue-bench
+
+#include "omniunit/omniunit.hh"
+#include "omniunit/queue.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+constexpr std::size_t samples = std::size_t(1) << 22;
+constexpr std::size_t batch = 4096;
+constexpr int runs = 5;
+
+volatile double sink = 0.;
+
+
+template <typename queue_t>
+double best_time(unsigned producers, bool batched)
+{
+  double best = 1e300;
+  for(int r = 0; r < runs; ++r)
+  {
+    queue_t queue(1 << 16);
+    std::vector<omni::second<double>> times(batch);
+    std::vector<omni::pascal_t<double>> values(batch);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(unsigned p = 0; p < producers; p++)
+      pool.emplace_back([&queue, producers]
+      {
+        for(std::size_t i = 0; i < samples / producers;)
+          if(queue.push(omni::nanosecond<std::int64_t>(static_cast<std::int64_t>(i)), omni::millibar<float>(1013.25f)))
+            i++;
+          else
+            std::this_thread::yield();
+      });
+
+    double total = 0.;
+    for(std::size_t popped = 0, count = 0; popped < samples / producers * producers; popped += count)
+    {
+      count = batched ? queue.pop(times, values) : queue.pop(times.data(), values.data(), 1);
+      for(std::size_t i = 0; i < count; i++)
+        total += values[i].count();
+      if(count == 0)
+        std::this_thread::yield();
+    }
+    for(std::thread& thread : pool)
+      thread.join();
+    sink = sink + total;
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / static_cast<double>(samples));
+  }
+  return best;
+}
+
+
+int main()
+{
+  unsigned producers = std::max(2u, std::thread::hardware_concurrency());
+  std::printf("%-28s %16s %16s\n", "", "one by one (ns)", "batches (ns)");
+  std::printf("%-28s %16.3f %16.3f\n", "spsc_queue, 1 producer", best_time<omni::spsc_queue<omni::millibar<float>>>(1, false),
+              best_time<omni::spsc_queue<omni::millibar<float>>>(1, true));
+  char name[32];
+  std::snprintf(name, sizeof(name), "mpsc_queue, %u producers", producers);
+  std::printf("%-28s %16.3f %16.3f\n", name, best_time<omni::mpsc_queue<omni::millibar<float>>>(producers, false),
+              best_time<omni::mpsc_queue<omni::millibar<float>>>(producers, true));
+  return 0;
+}
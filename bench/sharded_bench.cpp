@@ -0,0 +1,76 @@
+//sharded_bench.cpp
+
+// Cost of an addition to a counter of units shared by all hardware threads : an
+// omni::atomic_unit (see include/omniunit/atomic.hh) updated with fetch_add, and
+// omni::sharded_accumulator (see include/omniunit/sharded.hh), without and with
+// variance. Every thread adds 2^22 energies, and the best time of several runs is
+// printed in nanoseconds per addition and per thread, with the total as a check.
+//
+// usage :
+//   make sharded-bench
+
+#include "omniunit/omniunit.hh"
+#include "omniunit/atomic.hh"
+#include "omniunit/sharded.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+constexpr std::size_t additions = std::size_t(1) << 22;
+constexpr int runs = 5;
+
+
+template <typename function_t>
+double best_time(unsigned threads, function_t&& function)
+{
+  double best = 1e300;
+  for(int i = 0; i < runs; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(unsigned t = 0; t < threads; t++)
+      pool.emplace_back(function);
+    for(std::thread& thread : pool)
+      thread.join();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / static_cast<double>(additions));
+  }
+  return best;
+}
+
+
+int main()
+{
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("%u threads\n%-32s %14s %14s\n", threads, "", "ns per add", "total (kJ)");
+
+  omni::atomic_unit<omni::kilojoule<>> atomic;
+  double time = best_time(threads, [&]
+  {
+    for(std::size_t i = 0; i < additions; i++)
+      atomic.fetch_add(omni::joule<>(1.), std::memory_order_relaxed);
+  });
+  std::printf("%-32s %14.3f %14.0f\n", "atomic_unit::fetch_add", time, atomic.load().count());
+
+  omni::sharded_accumulator<omni::kilojoule<>> sharded;
+  time = best_time(threads, [&]
+  {
+    for(std::size_t i = 0; i < additions; i++)
+      sharded += omni::joule<>(1.);
+  });
+  std::printf("%-32s %14.3f %14.0f\n", "sharded_accumulator", time, sharded.sum().count());
+
+  omni::sharded_accumulator<omni::kilojoule<>, true> variance;
+  time = best_time(threads, [&]
+  {
+    for(std::size_t i = 0; i < additions; i++)
+      variance += omni::joule<>(1.);
+  });
+  std::printf("%-32s %14.3f %14.0f\n", "sharded_accumulator, variance", time, variance.sum().count());
+
+  return 0;
+}
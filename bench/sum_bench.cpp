@@ -0,0 +1,108 @@
+//sum_bench.cpp
+
+// Precision and throughput of the summation strategies of omni::sum
+// (see include/omniunit/reduce.hh).
+//
+// 2^23 small energy increments (exact multiples of 2^-40 J, below 1 mJ) are added
+// to a total of 1 MJ, so that their exact sum is known. For operator+= on
+// omni::joule<double> and for every strategy, on the calling thread and on an
+// omni::parallel::ThreadPool of all hardware threads, the error against the exact
+// sum and the best time of several runs (in nanoseconds per element) are printed.
+//
+// usage :
+//   make sum-bench
+
+#include "omniunit/omniunit.hh"
+#include "omniunit/reduce.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+constexpr std::size_t size = std::size_t(1) << 23;
+constexpr int runs = 10;
+
+volatile double sink = 0.;
+
+
+template <typename function_t>
+double best_time(function_t&& function)
+{
+  double best = 1e300;
+  for(int i = 0; i < runs; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / static_cast<double>(size));
+  }
+  return best;
+}
+
+
+void print(char const* name, unsigned threads, double result, long double exact, double time)
+{
+  std::printf("%-20s %8u %14.3Le %14.3f\n", name, threads, static_cast<long double>(result) - exact, time);
+}
+
+
+int main()
+{
+  std::mt19937_64 generator(42);
+  std::vector<omni::joule<double>> increments(size);
+  std::int64_t ticks = 0;
+  for(omni::joule<double>& increment : increments)
+  {
+    std::int64_t tick = static_cast<std::int64_t>(generator() % (std::uint64_t(1) << 30));
+    ticks += tick;
+    increment = omni::joule<double>(std::ldexp(static_cast<double>(tick), -40));
+  }
+  increments[0] += omni::joule<double>(1e6);
+  long double exact = std::ldexp(static_cast<long double>(ticks), -40) + 1e6L;
+
+  std::printf("%-20s %8s %14s %14s\n", "strategy", "threads", "error (J)", "ns per element");
+
+  double result = 0.;
+  double time = best_time([&]
+  {
+    omni::joule<double> total(0.);
+    for(omni::joule<double> const& increment : increments)
+      total += increment;
+    result = total.count();
+    sink = sink + result;
+  });
+  print("operator+=", 1, result, exact, time);
+
+  unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+  struct
+  {
+    char const* name;
+    omni::Summation strategy;
+  } const strategies[] = {{"Naive", omni::Summation::Naive}, {"Neumaier", omni::Summation::Neumaier},
+                          {"Pairwise", omni::Summation::Pairwise}, {"Blocked", omni::Summation::Blocked}};
+
+  omni::parallel::ThreadPool pool(hardware);
+  for(auto const& strategy : strategies)
+  {
+    time = best_time([&]
+    {
+      result = omni::sum(increments, strategy.strategy).count();
+      sink = sink + result;
+    });
+    print(strategy.name, 1, result, exact, time);
+    time = best_time([&]
+    {
+      result = omni::sum(increments, strategy.strategy, pool).count();
+      sink = sink + result;
+    });
+    print(strategy.name, hardware, result, exact, time);
+  }
+
+  return 0;
+}
@@ -0,0 +1,263 @@
+//atomic.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_ATOMIC_HH_
+#define OMNIUNIT_ATOMIC_HH_
+
+// omni::atomic_unit<U>, also reachable as std::atomic<U>, is a unit shared between
+// threads. Only the count is stored, in an std::atomic<U::rep> : an atomic meter<>
+// is a single 64 bits word, lock-free wherever std::atomic<double> is. Units loaded
+// from it have no uncertainty, and the uncertainty of stored units is dropped.
+//
+// store, exchange, compare_exchange_weak/strong, fetch_add and fetch_sub accept any
+// unit of the same dimension : the conversion to U is done before the atomic
+// operation, as in Unit::operator= and Unit::operator+=. fetch_add and fetch_sub are
+// native for integral Reps, and compare-exchange loops otherwise.
+//
+// like for std::atomic<double>, compare_exchange compares the object representations
+// of the counts : 0. and -0. differ, and a NaN count may be equal to itself.
+
+#include <atomic>
+#include <type_traits>
+
+#include "core/Unit.hh"
+
+
+
+namespace omni
+{
+
+
+
+template <typename U>
+class atomic_unit
+{
+  static_assert(is_Unit<U>::value, "omni::atomic_unit holds an omni::Unit.");
+  static_assert(std::is_trivially_copyable<typename U::rep>::value, "The Rep of an atomic unit should be trivially copyable.");
+
+  typedef typename U::rep rep;
+  typedef typename U::dim dim;
+
+  template <typename T>
+  using enable_same_dimension = typename std::enable_if<is_Unit<T>::value && std::is_same<typename T::dim, dim>::value>::type;
+
+  public:
+
+  typedef U value_type;
+
+  static constexpr bool is_always_lock_free = std::atomic<rep>::is_always_lock_free;
+
+
+  atomic_unit() noexcept:
+  _count(static_cast<rep>(0))
+  {
+  }
+
+  constexpr atomic_unit(U const& desired) noexcept:
+  _count(desired.count())
+  {
+  }
+
+  template <typename T, typename = enable_same_dimension<T>>
+  atomic_unit(T const& desired):
+  _count(U(desired).count())
+  {
+  }
+
+  atomic_unit(atomic_unit const&) = delete;
+  atomic_unit& operator=(atomic_unit const&) = delete;
+  atomic_unit& operator=(atomic_unit const&) volatile = delete;
+
+
+  bool is_lock_free() const noexcept
+  {
+    return _count.is_lock_free();
+  }
+
+
+  template <typename T, typename = enable_same_dimension<T>>
+  void store(T const& desired, std::memory_order order = std::memory_order_seq_cst)
+  {
+    _count.store(U(desired).count(), order);
+  }
+
+  //unlike std::atomic, returns *this
+  template <typename T, typename = enable_same_dimension<T>>
+  atomic_unit& operator=(T const& desired)
+  {
+    store(desired);
+    return *this;
+  }
+
+
+  U load(std::memory_order order = std::memory_order_seq_cst) const
+  {
+    return U(_count.load(order));
+  }
+
+  operator U() const
+  {
+    return load();
+  }
+
+
+  template <typename T, typename = enable_same_dimension<T>>
+  U exchange(T const& desired, std::memory_order order = std::memory_order_seq_cst)
+  {
+    return U(_count.exchange(U(desired).count(), order));
+  }
+
+
+  //on failure, expected is set to the current value
+  template <typename T, typename = enable_same_dimension<T>>
+  bool compare_exchange_weak(U& expected, T const& desired, std::memory_order success, std::memory_order failure)
+  {
+    rep count = expected.count();
+    bool exchanged = _count.compare_exchange_weak(count, U(desired).count(), success, failure);
+    expected = U(count);
+    return exchanged;
+  }
+
+  template <typename T, typename = enable_same_dimension<T>>
+  bool compare_exchange_weak(U& expected, T const& desired, std::memory_order order = std::memory_order_seq_cst)
+  {
+    rep count = expected.count();
+    bool exchanged = _count.compare_exchange_weak(count, U(desired).count(), order);
+    expected = U(count);
+    return exchanged;
+  }
+
+  template <typename T, typename = enable_same_dimension<T>>
+  bool compare_exchange_strong(U& expected, T const& desired, std::memory_order success, std::memory_order failure)
+  {
+    rep count = expected.count();
+    bool exchanged = _count.compare_exchange_strong(count, U(desired).count(), success, failure);
+    expected = U(count);
+    return exchanged;
+  }
+
+  template <typename T, typename = enable_same_dimension<T>>
+  bool compare_exchange_strong(U& expected, T const& desired, std::memory_order order = std::memory_order_seq_cst)
+  {
+    rep count = expected.count();
+    bool exchanged = _count.compare_exchange_strong(count, U(desired).count(), order);
+    expected = U(count);
+    return exchanged;
+  }
+
+
+  //returns the value before the addition
+  template <typename T, typename = enable_same_dimension<T>>
+  U fetch_add(T const& delta, std::memory_order order = std::memory_order_seq_cst)
+  {
+    return U(add(count_of(delta), order));
+  }
+
+  //returns the value before the subtraction
+  template <typename T, typename = enable_same_dimension<T>>
+  U fetch_sub(T const& delta, std::memory_order order = std::memory_order_seq_cst)
+  {
+    return U(add(static_cast<rep>(-count_of(delta)), order));
+  }
+
+  //returns the value after the addition
+  template <typename T, typename = enable_same_dimension<T>>
+  U operator+=(T const& delta)
+  {
+    rep count = count_of(delta);
+    return U(static_cast<rep>(add(count, std::memory_order_seq_cst) + count));
+  }
+
+  //returns the value after the subtraction
+  template <typename T, typename = enable_same_dimension<T>>
+  U operator-=(T const& delta)
+  {
+    rep count = static_cast<rep>(-count_of(delta));
+    return U(static_cast<rep>(add(count, std::memory_order_seq_cst) + count));
+  }
+
+
+  private:
+
+  //count of delta in the period of U, keeping the origin of delta as Unit::operator+= does
+  template <typename T>
+  static rep count_of(T const& delta)
+  {
+    return Unit<dim, rep, typename U::period, T::origin>(delta).count();
+  }
+
+
+  rep add(rep count, std::memory_order order)
+  {
+    if constexpr(std::is_integral<rep>::value)
+    {
+      return _count.fetch_add(count, order);
+    }
+    else
+    {
+      rep current = _count.load(std::memory_order_relaxed);
+      while(!_count.compare_exchange_weak(current, static_cast<rep>(current + count), order, std::memory_order_relaxed))
+      {
+      }
+      return current;
+    }
+  }
+
+
+  std::atomic<rep> _count;
+};
+
+
+
+} //namespace omni
+
+
+
+namespace std _GLIBCXX_VISIBILITY(default)
+{
+
+
+
+template<typename Dimension, typename Rep, typename Period, double const& Origin>
+struct atomic<omni::Unit<Dimension, Rep, Period, Origin>> : public omni::atomic_unit<omni::Unit<Dimension, Rep, Period, Origin>>
+{
+  using omni::atomic_unit<omni::Unit<Dimension, Rep, Period, Origin>>::atomic_unit;
+  using omni::atomic_unit<omni::Unit<Dimension, Rep, Period, Origin>>::operator=;
+};
+
+
+
+} //namespace std
+
+#endif //OMNIUNIT_ATOMIC_HH_
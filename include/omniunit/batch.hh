@@ -0,0 +1,553 @@
+//batch.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_BATCH_HH_
+#define OMNIUNIT_BATCH_HH_
+
+// omni::batch::sin(units, size, out), or omni::batch::sin(units, out) with containers
+// (data() and size()), compute the elementary functions of Unit.hh over arrays
+// of dimensionless (or angle) units. The dimension is checked at compile time,
+// the conversion to the base period is a constant of the call, and the values
+// go through branch-free polynomial kernels that the compiler vectorizes
+// (-O3, or -O2 -ftree-vectorize). Results are written as in the scalar
+// functions : raw values of the Rep (double for integer Reps).
+//
+// accuracy of the kernels (double, measured against long double on 4e6 points) :
+//   exp, log, atan          < 1 ulp
+//   sin, cos                < 1.5 ulp for |x| <= 10, < 2.5 ulp for |x| <= 8e5 (close
+//                           to the zeros of sin and cos as well)
+//   tan                     < 3 ulp for |x| <= 10, < 4.5 ulp for |x| <= 8e5
+//   sinh, cosh              < 2 ulp
+//   tanh                    < 3 ulp
+// Elements outside the domain of a kernel (|x| > 8e5 for trigonometry, |x| > 708
+// for exp, sinh and cosh, subnormal or non-positive x for log, inf and NaN) are
+// computed again by <cmath>. float Reps are computed in double, long double Reps
+// only by <cmath>.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "core/Unit.hh"
+
+
+
+namespace omni
+{
+namespace batch
+{
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== KERNELS =================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+namespace kernel
+{
+
+
+static_assert(std::numeric_limits<double>::is_iec559 && sizeof(double) == sizeof(std::uint64_t),
+"Batch kernels need IEEE 754 doubles.");
+
+
+inline double from_bits(std::uint64_t bits)
+{
+  double value = 0;
+  std::memcpy(&value, &bits, sizeof(double));
+  return value;
+}
+
+
+inline std::uint64_t to_bits(double value)
+{
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(double));
+  return bits;
+}
+
+
+//selects without branches : a when the low bit of odd is 0, b otherwise.
+//Ternaries on computed floating points are not if-converted (they could trap).
+inline double pick(std::uint64_t odd, double a, double b)
+{
+  std::uint64_t mask = 0 - (odd & 1);
+  return from_bits((to_bits(b) & mask) | (to_bits(a) & ~mask));
+}
+
+
+//1 if a > c, for a >= 0 and c > 0 : positive doubles are ordered like their bits.
+//Comparisons of doubles would not vectorize into 64-bit masks before SSE4.2.
+inline std::uint64_t greater(double a, double c)
+{
+  return (to_bits(c) - to_bits(a)) >> 63;
+}
+
+
+//negates v when the second bit of quadrant is set
+inline double flip(std::uint64_t quadrant, double v)
+{
+  return from_bits(to_bits(v) ^ ((quadrant & 2) << 62));
+}
+
+
+//adding 1.5 * 2^52 rounds to an integer, which is then in the low bits
+inline constexpr double roundMagic = 6755399441055744.0;
+inline constexpr double twoOverPi = 6.36619772367581382433e-01;
+inline constexpr double log2e = 1.44269504088896338700e+00;
+inline constexpr double trigLimit = 8e5;
+inline constexpr double expLimit = 708.;
+
+
+//x - k * pi/2 in [-pi/4, pi/4], with pi/2 in four parts (fdlibm pio2_1, 2, 3 and 3t) :
+//the three first products are exact as long as k < 2^20, and the last one keeps the
+//relative accuracy of results close to the zeros (sin(20 pi) is 1e-15).
+inline double reduce_half_pi(double x, std::uint64_t& quadrant)
+{
+  double t = x * twoOverPi + roundMagic;
+  quadrant = to_bits(t);
+  double k = t - roundMagic;
+  return (((x - k * 1.57079632673412561417e+00) - k * 6.07710050630396597660e-11) - k * 2.02226624871116645580e-21)
+    - k * 8.47842766036889956997e-32;
+}
+
+
+//fdlibm __kernel_sin and __kernel_cos on [-pi/4, pi/4]
+inline double sin_poly(double x)
+{
+  double z = x * x;
+  double r = 8.33333333332248946124e-03 + z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06
+    + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)));
+  return x + z * x * (-1.66666666666666324348e-01 + z * r);
+}
+
+
+inline double cos_poly(double x)
+{
+  double z = x * x;
+  double r = z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 + z * (2.48015872894767294178e-05
+    + z * (-2.75573143513906633035e-07 + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+  double hz = 0.5 * z;
+  double w = 1. - hz;
+  return w + (((1. - w) - hz) + z * r);
+}
+
+
+//fdlibm exp : x = k ln2 + r, then a rational approximation of exp(r)
+inline double exp_core(double x)
+{
+  double t = x * log2e + roundMagic;
+  std::uint64_t bits = to_bits(t);
+  double k = t - roundMagic;
+  double hi = x - k * 6.93147180369123816490e-01;
+  double lo = k * 1.90821492927058770002e-10;
+  double r = hi - lo;
+  double z = r * r;
+  double c = r - z * (1.66666666666666019037e-01 + z * (-2.77777777770155933842e-03 + z * (6.61375632143793436117e-05
+    + z * (-1.65339022054652515390e-06 + z * 4.13813679705723846039e-08))));
+  double y = 1. - ((lo - (r * c) / (2. - c)) - hi);
+  return y * from_bits((bits + 1023) << 52); // 2^k
+}
+
+
+inline double sinh_series(double x)
+{
+  double z = x * x;
+  return x + x * z * (1./6 + z * (1./120 + z * (1./5040 + z * (1./362880 + z * (1./39916800
+    + z * (1./6227020800 + z * (1./1307674368000 + z * (1./355687428096000))))))));
+}
+
+
+inline double cosh_series(double x)
+{
+  double z = x * x;
+  return 1. + z * (1./2 + z * (1./24 + z * (1./720 + z * (1./40320 + z * (1./3628800
+    + z * (1./479001600 + z * (1./87178291200 + z * (1./20922789888000))))))));
+}
+
+
+struct sin
+{
+  static double compute(double x)
+  {
+    std::uint64_t quadrant = 0;
+    double r = reduce_half_pi(x, quadrant);
+    return flip(quadrant, pick(quadrant, sin_poly(r), cos_poly(r)));
+  }
+  static bool valid(double x) {return std::abs(x) <= trigLimit;}
+  template <typename T> static T fallback(T x) {return std::sin(x);}
+};
+
+
+struct cos
+{
+  static double compute(double x)
+  {
+    std::uint64_t quadrant = 0;
+    double r = reduce_half_pi(x, quadrant);
+    return flip(quadrant + 1, pick(quadrant, cos_poly(r), sin_poly(r)));
+  }
+  static bool valid(double x) {return std::abs(x) <= trigLimit;}
+  template <typename T> static T fallback(T x) {return std::cos(x);}
+};
+
+
+struct tan
+{
+  static double compute(double x)
+  {
+    std::uint64_t quadrant = 0;
+    double r = reduce_half_pi(x, quadrant);
+    double s = sin_poly(r);
+    double c = cos_poly(r);
+    double even = s / c;
+    double odd = -c / s;
+    return pick(quadrant, even, odd);
+  }
+  static bool valid(double x) {return std::abs(x) <= trigLimit;}
+  template <typename T> static T fallback(T x) {return std::tan(x);}
+};
+
+
+//Cephes atan : reduction to |x| <= tan(pi/8) with pi/2 or pi/4, then a rational approximation
+struct atan
+{
+  static double compute(double x)
+  {
+    double a = std::abs(x);
+    std::uint64_t big = greater(a, 2.41421356237309504880);
+    std::uint64_t mid = greater(a, 0.66);
+    double num = pick(big, pick(mid, a, a - 1.), -1.);
+    double den = pick(big, pick(mid, 1., a + 1.), a);
+    double y0 = pick(big, pick(mid, 0., 7.85398163397448309616e-01), 1.57079632679489661923e+00);
+    double extra = pick(big, pick(mid, 0., 3.061616997868382943065e-17), 6.123233995736765886130e-17);
+    double xr = num / den;
+    double z = xr * xr;
+    double p = (((-8.750608600031904122785e-01 * z - 1.615753718733365076637e+01) * z - 7.500855792314704667340e+01) * z
+      - 1.228866684490136173410e+02) * z - 6.485021904942025371773e+01;
+    double q = ((((z + 2.485846490142306297962e+01) * z + 1.650270098316988542046e+02) * z + 4.328810604912902668951e+02) * z
+      + 4.853903996359136964868e+02) * z + 1.945506571482613964425e+02;
+    return std::copysign(y0 + ((xr * (z * p / q) + xr) + extra), x);
+  }
+  static bool valid(double x) {return std::abs(x) <= std::numeric_limits<double>::max();}
+  template <typename T> static T fallback(T x) {return std::atan(x);}
+};
+
+
+struct exp
+{
+  static double compute(double x) {return exp_core(x);}
+  static bool valid(double x) {return std::abs(x) <= expLimit;}
+  template <typename T> static T fallback(T x) {return std::exp(x);}
+};
+
+
+//fdlibm log : x = m 2^e with m in [sqrt(2)/2, sqrt(2)), then log(m) = 2 atanh((m-1)/(m+1))
+struct log
+{
+  static double compute(double x)
+  {
+    std::uint64_t bits = to_bits(x);
+    double m = from_bits((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    double e = from_bits(0x4330000000000000ULL | (bits >> 52)) - (4503599627370496. + 1023.);
+    std::uint64_t big = greater(m, 1.41421356237309504880);
+    double halfM = 0.5 * m;
+    double nextE = e + 1.;
+    m = pick(big, m, halfM);
+    e = pick(big, e, nextE);
+
+    double f = m - 1.;
+    double s = f / (2. + f);
+    double z = s * s;
+    double w = z * z;
+    double t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+    double t2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01 + w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+    double hfsq = 0.5 * f * f;
+    return e * 6.93147180369123816490e-01 - ((hfsq - (s * (hfsq + t2 + t1) + e * 1.90821492927058770002e-10)) - f);
+  }
+  static bool valid(double x) {return x >= std::numeric_limits<double>::min() && x <= std::numeric_limits<double>::max();}
+  template <typename T> static T fallback(T x) {return std::log(x);}
+};
+
+
+struct sinh
+{
+  static double compute(double x)
+  {
+    double a = std::abs(x);
+    double e = exp_core(a);
+    double large = 0.5 * e - 0.5 / e;
+    double small = sinh_series(a);
+    return std::copysign(pick(greater(a, 1.), small, large), x);
+  }
+  static bool valid(double x) {return std::abs(x) <= expLimit;}
+  template <typename T> static T fallback(T x) {return std::sinh(x);}
+};
+
+
+struct cosh
+{
+  static double compute(double x)
+  {
+    double e = exp_core(std::abs(x));
+    return 0.5 * e + 0.5 / e;
+  }
+  static bool valid(double x) {return std::abs(x) <= expLimit;}
+  template <typename T> static T fallback(T x) {return std::cosh(x);}
+};
+
+
+//tanh(20) is 1 in double
+struct tanh
+{
+  static double compute(double x)
+  {
+    double a = std::abs(x);
+    a = pick(greater(a, 20.), a, 20.);
+    double small = sinh_series(a) / cosh_series(a);
+    double large = 1. - 2. / (exp_core(2. * a) + 1.);
+    return std::copysign(pick(greater(a, 1.), small, large), x);
+  }
+  static bool valid(double x) {return std::abs(x) <= std::numeric_limits<double>::max();}
+  template <typename T> static T fallback(T x) {return std::tanh(x);}
+};
+
+
+} //namespace kernel
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== BATCH APPLICATION =======================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//same result type as the scalar functions (std::sin of the count) ; 16 bits
+//floating points give floats
+template <typename Rep>
+using result_t = typename std::conditional<std::is_integral<Rep>::value, double,
+  typename std::conditional<is_Float16<Rep>::value, float, Rep>::type>::type;
+
+
+//blocks stay in L1 : conversion, kernel and fix-up of a block run on the same data.
+//The fix-up pass is a scan with a branch that is almost never taken.
+inline constexpr std::size_t blockSize = 256;
+
+
+template <typename Kernel, typename _Dimension, typename Rep, typename Period, double const& Origin>
+void apply(Unit<_Dimension, Rep, Period, Origin> const* in, std::size_t size, result_t<Rep>* out)
+{
+  static_assert(std::is_same<_Dimension, Dimension<0,0,0,0,0,0,0>>::value, "Batch functions need dimensionless units.");
+
+  typedef Unit<_Dimension, Rep, Period, Origin> unit;
+  typedef Conversion<unit, Unit<_Dimension, Rep, base, Origin>> conv;
+  constexpr double offset = OMNI_TRUE_ZERO ? Origin : 0.;
+
+  if constexpr(std::is_same<Rep, long double>::value)
+  {
+    for(std::size_t i = 0; i < size; i++)
+      out[i] = Kernel::fallback(static_cast<long double>(in[i].count()) * conv::num / conv::den + offset);
+  }
+  else
+  {
+    double x[blockSize];
+    for(std::size_t start = 0; start < size; start += blockSize)
+    {
+      std::size_t count = std::min(blockSize, size - start);
+      result_t<Rep>* y = out + start;
+      for(std::size_t i = 0; i < count; i++)
+        x[i] = static_cast<double>(in[start + i].count()) * conv::num / conv::den + offset;
+      for(std::size_t i = 0; i < count; i++)
+        y[i] = static_cast<result_t<Rep>>(Kernel::compute(x[i]));
+      for(std::size_t i = 0; i < count; i++)
+        if(!Kernel::valid(x[i]))
+          y[i] = static_cast<result_t<Rep>>(Kernel::fallback(x[i]));
+    }
+  }
+}
+
+
+template <typename Kernel, typename InContainer, typename OutContainer>
+void apply(InContainer const& in, OutContainer& out)
+{
+  if(out.size() < in.size())
+    throw std::length_error("omni::batch : output is smaller than input.");
+  apply<Kernel>(in.data(), in.size(), out.data());
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== BATCH FUNCTIONS =========================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+#define OMNI_BATCH_FUNCTION(name) \
+template <typename _Dimension, typename Rep, typename Period, double const& Origin> \
+void name(Unit<_Dimension, Rep, Period, Origin> const* in, std::size_t size, result_t<Rep>* out) \
+{ \
+  apply<kernel::name>(in, size, out); \
+} \
+\
+template <typename InContainer, typename OutContainer> \
+auto name(InContainer const& in, OutContainer& out) -> decltype(in.data(), out.data(), void()) \
+{ \
+  apply<kernel::name>(in, out); \
+}
+
+
+OMNI_BATCH_FUNCTION(sin)
+OMNI_BATCH_FUNCTION(cos)
+OMNI_BATCH_FUNCTION(tan)
+OMNI_BATCH_FUNCTION(atan)
+OMNI_BATCH_FUNCTION(exp)
+OMNI_BATCH_FUNCTION(log)
+OMNI_BATCH_FUNCTION(sinh)
+OMNI_BATCH_FUNCTION(cosh)
+OMNI_BATCH_FUNCTION(tanh)
+
+
+#undef OMNI_BATCH_FUNCTION
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== 16 BITS STORAGE =========================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//units stored with 16 bits (omni::half or omni::bfloat16) to units of float or double,
+//counts and uncertainties converted by blocks (with F16C when it is enabled)
+template <typename _Dimension, Float16Format format, typename Period, double const& Origin, typename Rep>
+void widen(Unit<_Dimension, Float16<format>, Period, Origin> const* in, std::size_t size, Unit<_Dimension, Rep, Period, Origin>* out)
+{
+  static_assert(std::is_floating_point<Rep>::value, "Units are widened to floating points.");
+
+  Float16<format> count16[blockSize];
+  Float16<format> uncertainty16[blockSize];
+  float count[blockSize];
+  float uncertainty[blockSize];
+
+  for(std::size_t start = 0; start < size; start += blockSize)
+  {
+    std::size_t n = std::min(blockSize, size - start);
+    for(std::size_t i = 0; i < n; i++)
+    {
+      count16[i] = in[start + i].count();
+      uncertainty16[i] = static_cast<Float16<format>>(in[start + i].absolute());
+    }
+    omni::widen(count16, n, count);
+    omni::widen(uncertainty16, n, uncertainty);
+    for(std::size_t i = 0; i < n; i++)
+      out[start + i] = Unit<_Dimension, Rep, Period, Origin>(static_cast<Rep>(count[i]), static_cast<Rep>(uncertainty[i]));
+  }
+}
+
+
+//units to units stored with 16 bits, rounded to nearest even
+template <typename _Dimension, typename Rep, typename Period, double const& Origin, Float16Format format>
+void narrow(Unit<_Dimension, Rep, Period, Origin> const* in, std::size_t size, Unit<_Dimension, Float16<format>, Period, Origin>* out)
+{
+  static_assert(std::is_floating_point<Rep>::value, "Units are narrowed from floating points.");
+
+  float count[blockSize];
+  float uncertainty[blockSize];
+  Float16<format> count16[blockSize];
+  Float16<format> uncertainty16[blockSize];
+
+  for(std::size_t start = 0; start < size; start += blockSize)
+  {
+    std::size_t n = std::min(blockSize, size - start);
+    for(std::size_t i = 0; i < n; i++)
+    {
+      count[i] = static_cast<float>(in[start + i].count());
+      uncertainty[i] = static_cast<float>(in[start + i].absolute());
+    }
+    omni::narrow(count, n, count16);
+    omni::narrow(uncertainty, n, uncertainty16);
+    for(std::size_t i = 0; i < n; i++)
+      out[start + i] = Unit<_Dimension, Float16<format>, Period, Origin>(count16[i], uncertainty16[i]);
+  }
+}
+
+
+template <typename InContainer, typename OutContainer>
+auto widen(InContainer const& in, OutContainer& out) -> decltype(in.data(), out.data(), void())
+{
+  if(out.size() < in.size())
+    throw std::length_error("omni::batch : output is smaller than input.");
+  widen(in.data(), in.size(), out.data());
+}
+
+
+template <typename InContainer, typename OutContainer>
+auto narrow(InContainer const& in, OutContainer& out) -> decltype(in.data(), out.data(), void())
+{
+  if(out.size() < in.size())
+    throw std::length_error("omni::batch : output is smaller than input.");
+  narrow(in.data(), in.size(), out.data());
+}
+
+
+
+} //namespace batch
+} //namespace omni
+
+#endif //OMNIUNIT_BATCH_HH_
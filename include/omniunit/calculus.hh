@@ -0,0 +1,545 @@
+//calculus.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_CALCULUS_HH_
+#define OMNIUNIT_CALCULUS_HH_
+
+// numerical integration and differentiation of series of units sampled along an
+// axis of units (most often a duration) : the integral of watts over seconds is
+// in joules, the derivative of meters over seconds in meters per second. Result
+// types are those of operator* and operator/ (Dimension_multiply, Ratio_times_Ratio,
+// Dimension_divide, Ratio_over_Ratio), so they convert implicitly to any unit of the
+// same dimension.
+//
+// the axis is given as an array of sample positions, or as a constant step (a unit).
+// Counts are read by blocks and computed in double (long double for long double
+// Reps) with independent partial sums, that the compiler vectorizes (-O3, or -O2
+// -ftree-vectorize). Results carry no uncertainty.
+//
+//   trapezoid             trapezoidal rule
+//   simpson               composite Simpson's rule (for irregular steps as well), the last
+//                         interval of an odd number of intervals taking a third order correction
+//   cumulative_trapezoid  running integral, out[0] being zero
+//   derivative            second order central differences inside (for irregular steps as
+//                         well), first order one-sided differences at both ends
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "core/Unit.hh"
+#include "core/kernels.hh"
+
+
+
+namespace omni
+{
+namespace calculus
+{
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== RESULT TYPES ============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//type of value * axis : the integral of ValueUnit along AxisUnit
+template <typename ValueUnit, typename AxisUnit>
+struct integral_type
+{
+};
+
+
+template <typename Dimension1, typename Rep1, typename Period1, double const& Origin1,
+          typename Dimension2, typename Rep2, typename Period2, double const& Origin2>
+struct integral_type<Unit<Dimension1, Rep1, Period1, Origin1>, Unit<Dimension2, Rep2, Period2, Origin2>>
+{
+  typedef Unit<typename Dimension_multiply<Dimension1, Dimension2>::type, typename std::common_type<Rep1, Rep2>::type,
+    typename Ratio_times_Ratio<Period1, Period2>::type, origin_product<Origin1, zero>::value> type;
+};
+
+
+//type of value / axis : the derivative of ValueUnit along AxisUnit (differences have no origin)
+template <typename ValueUnit, typename AxisUnit>
+struct derivative_type
+{
+};
+
+
+template <typename Dimension1, typename Rep1, typename Period1, double const& Origin1,
+          typename Dimension2, typename Rep2, typename Period2, double const& Origin2>
+struct derivative_type<Unit<Dimension1, Rep1, Period1, Origin1>, Unit<Dimension2, Rep2, Period2, Origin2>>
+{
+  typedef Unit<typename Dimension_divide<Dimension1, Dimension2>::type, typename std::common_type<Rep1, Rep2>::type,
+    typename Ratio_over_Ratio<Period1, Period2>::type, zero> type;
+};
+
+
+template <typename ValueUnit, typename AxisUnit>
+using integral_t = typename integral_type<ValueUnit, AxisUnit>::type;
+
+template <typename ValueUnit, typename AxisUnit>
+using derivative_t = typename derivative_type<ValueUnit, AxisUnit>::type;
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== BLOCKS ==================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+namespace detail
+{
+
+
+using kernel_detail::accumulator_t;
+using kernel_detail::lane_sum;
+
+
+//blocks stay in L1 ; blockSize is even so that Simpson's pairs of intervals do not straddle blocks
+inline constexpr std::size_t blockSize = 256;
+
+
+//counts of size values, in their own period (origin added if OMNI_TRUE_ZERO, like operator*)
+template <typename acc, typename Dimension, typename Rep, typename Period, double const& Origin>
+void load(Unit<Dimension, Rep, Period, Origin> const* values, std::size_t size, acc* out)
+{
+  constexpr acc offset = (OMNI_TRUE_ZERO ? static_cast<acc>(Origin / Period::value) : acc(0));
+  for(std::size_t i = 0; i < size; i++)
+    out[i] = static_cast<acc>(values[i].count()) + offset;
+}
+
+
+//size steps between size + 1 positions, subtracted in the Rep of the axis (exact for integers)
+template <typename acc, typename AxisUnit>
+void load_steps(AxisUnit const* axis, std::size_t size, acc* out)
+{
+  for(std::size_t i = 0; i < size; i++)
+    out[i] = static_cast<acc>(axis[i + 1].count() - axis[i].count());
+}
+
+
+//Simpson's rule on two intervals h0, h1
+template <typename acc>
+acc simpson_pair(acc f0, acc f1, acc f2, acc h0, acc h1)
+{
+  acc h = h0 + h1;
+  return h / 6 * ((2 - h1 / h0) * f0 + h * h / (h0 * h1) * f1 + (2 - h0 / h1) * f2);
+}
+
+
+//last interval (h1, after h0) of an odd number of intervals
+template <typename acc>
+acc simpson_end(acc f0, acc f1, acc f2, acc h0, acc h1)
+{
+  acc alpha = (2 * h1 * h1 + 3 * h0 * h1) / (6 * (h0 + h1));
+  acc beta = (h1 * h1 + 3 * h0 * h1) / (6 * h0);
+  acc eta = h1 * h1 * h1 / (6 * h0 * (h0 + h1));
+  return alpha * f2 + beta * f1 - eta * f0;
+}
+
+
+//derivative at the middle of three samples
+template <typename acc>
+acc central_difference(acc f0, acc f1, acc f2, acc h0, acc h1)
+{
+  return (h0 * h0 * f2 - h1 * h1 * f0 + (h1 * h1 - h0 * h0) * f1) / (h0 * h1 * (h0 + h1));
+}
+
+
+} //namespace detail
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== INTEGRATION =============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <typename ValueUnit, typename AxisUnit>
+integral_t<ValueUnit, AxisUnit> trapezoid(ValueUnit const* values, AxisUnit const* axis, std::size_t size)
+{
+  typedef integral_t<ValueUnit, AxisUnit> result;
+  typedef detail::accumulator_t<typename result::rep> acc;
+
+  acc f[detail::blockSize + 1];
+  acc h[detail::blockSize];
+  acc total = 0;
+  for(std::size_t start = 0; start + 1 < size; start += detail::blockSize)
+  {
+    std::size_t n = std::min(detail::blockSize, size - 1 - start);
+    detail::load(values + start, n + 1, f);
+    detail::load_steps(axis + start, n, h);
+    total += detail::lane_sum<acc>(n, [&](std::size_t i) {return (f[i] + f[i + 1]) * h[i];});
+  }
+  return result(total / 2);
+}
+
+
+template <typename ValueUnit, typename AxisUnit>
+integral_t<ValueUnit, AxisUnit> trapezoid(ValueUnit const* values, std::size_t size, AxisUnit const& step)
+{
+  typedef integral_t<ValueUnit, AxisUnit> result;
+  typedef detail::accumulator_t<typename result::rep> acc;
+
+  if(size < 2)
+    return result(0);
+
+  acc f[detail::blockSize];
+  acc total = 0;
+  for(std::size_t start = 0; start < size; start += detail::blockSize)
+  {
+    std::size_t n = std::min(detail::blockSize, size - start);
+    detail::load(values + start, n, f);
+    total += detail::lane_sum<acc>(n, [&](std::size_t i) {return f[i];});
+  }
+  acc ends[2];
+  detail::load(values, 1, ends);
+  detail::load(values + size - 1, 1, ends + 1);
+  return result((total - (ends[0] + ends[1]) / 2) * static_cast<acc>(step.count()));
+}
+
+
+template <typename ValueUnit, typename AxisUnit>
+integral_t<ValueUnit, AxisUnit> simpson(ValueUnit const* values, AxisUnit const* axis, std::size_t size)
+{
+  typedef integral_t<ValueUnit, AxisUnit> result;
+  typedef detail::accumulator_t<typename result::rep> acc;
+
+  if(size < 3)
+    return trapezoid(values, axis, size);
+
+  //pairs of intervals, then the last one if their number is odd
+  std::size_t even = (size - 1) & ~std::size_t(1);
+  acc f[detail::blockSize + 1];
+  acc h[detail::blockSize];
+  acc total = 0;
+  for(std::size_t start = 0; start < even; start += detail::blockSize)
+  {
+    std::size_t n = std::min(detail::blockSize, even - start);
+    detail::load(values + start, n + 1, f);
+    detail::load_steps(axis + start, n, h);
+    total += detail::lane_sum<acc>(n / 2, [&](std::size_t k) {return detail::simpson_pair(f[2 * k], f[2 * k + 1], f[2 * k + 2], h[2 * k], h[2 * k + 1]);});
+  }
+  if(even != size - 1)
+  {
+    detail::load(values + size - 3, 3, f);
+    detail::load_steps(axis + size - 3, 2, h);
+    total += detail::simpson_end(f[0], f[1], f[2], h[0], h[1]);
+  }
+  return result(total);
+}
+
+
+template <typename ValueUnit, typename AxisUnit>
+integral_t<ValueUnit, AxisUnit> simpson(ValueUnit const* values, std::size_t size, AxisUnit const& step)
+{
+  typedef integral_t<ValueUnit, AxisUnit> result;
+  typedef detail::accumulator_t<typename result::rep> acc;
+
+  if(size < 3)
+    return trapezoid(values, size, step);
+
+  acc dx = static_cast<acc>(step.count());
+  std::size_t even = (size - 1) & ~std::size_t(1);
+  acc f[detail::blockSize + 1];
+  acc total = 0;
+  for(std::size_t start = 0; start < even; start += detail::blockSize)
+  {
+    std::size_t n = std::min(detail::blockSize, even - start);
+    detail::load(values + start, n + 1, f);
+    total += detail::lane_sum<acc>(n / 2, [&](std::size_t k) {return f[2 * k] + 4 * f[2 * k + 1] + f[2 * k + 2];});
+  }
+  total *= dx / 3;
+  if(even != size - 1)
+  {
+    detail::load(values + size - 3, 3, f);
+    total += detail::simpson_end(f[0], f[1], f[2], dx, dx);
+  }
+  return result(total);
+}
+
+
+//out[i] is the integral from the first sample to the i-th one
+template <typename ValueUnit, typename AxisUnit, typename OutUnit>
+void cumulative_trapezoid(ValueUnit const* values, AxisUnit const* axis, std::size_t size, OutUnit* out)
+{
+  typedef integral_t<ValueUnit, AxisUnit> result;
+  typedef detail::accumulator_t<typename result::rep> acc;
+
+  if(size == 0)
+    return;
+
+  acc f[detail::blockSize + 1];
+  acc h[detail::blockSize];
+  acc area[detail::blockSize];
+  acc total = 0;
+  out[0] = OutUnit(result(0));
+  for(std::size_t start = 0; start + 1 < size; start += detail::blockSize)
+  {
+    std::size_t n = std::min(detail::blockSize, size - 1 - start);
+    detail::load(values + start, n + 1, f);
+    detail::load_steps(axis + start, n, h);
+    for(std::size_t i = 0; i < n; i++)
+      area[i] = (f[i] + f[i + 1]) * h[i] / 2;
+    for(std::size_t i = 0; i < n; i++)
+    {
+      total += area[i];
+      out[start + i + 1] = OutUnit(result(total));
+    }
+  }
+}
+
+
+template <typename ValueUnit, typename AxisUnit, typename OutUnit>
+void cumulative_trapezoid(ValueUnit const* values, std::size_t size, AxisUnit const& step, OutUnit* out)
+{
+  typedef integral_t<ValueUnit, AxisUnit> result;
+  typedef detail::accumulator_t<typename result::rep> acc;
+
+  if(size == 0)
+    return;
+
+  acc halfStep = static_cast<acc>(step.count()) / 2;
+  acc f[detail::blockSize + 1];
+  acc area[detail::blockSize];
+  acc total = 0;
+  out[0] = OutUnit(result(0));
+  for(std::size_t start = 0; start + 1 < size; start += detail::blockSize)
+  {
+    std::size_t n = std::min(detail::blockSize, size - 1 - start);
+    detail::load(values + start, n + 1, f);
+    for(std::size_t i = 0; i < n; i++)
+      area[i] = (f[i] + f[i + 1]) * halfStep;
+    for(std::size_t i = 0; i < n; i++)
+    {
+      total += area[i];
+      out[start + i + 1] = OutUnit(result(total));
+    }
+  }
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== DIFFERENTIATION =========================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <typename ValueUnit, typename AxisUnit, typename OutUnit>
+void derivative(ValueUnit const* values, AxisUnit const* axis, std::size_t size, OutUnit* out)
+{
+  typedef derivative_t<ValueUnit, AxisUnit> result;
+  typedef detail::accumulator_t<typename result::rep> acc;
+
+  if(size < 2)
+  {
+    if(size == 1)
+      out[0] = OutUnit(result(0));
+    return;
+  }
+
+  acc f[detail::blockSize + 2];
+  acc h[detail::blockSize + 1];
+  acc d[detail::blockSize];
+
+  //inner points i, from the samples i - 1 to i + 1
+  for(std::size_t start = 1; start + 1 < size; start += detail::blockSize)
+  {
+    std::size_t n = std::min(detail::blockSize, size - 1 - start);
+    detail::load(values + start - 1, n + 2, f);
+    detail::load_steps(axis + start - 1, n + 1, h);
+    for(std::size_t i = 0; i < n; i++)
+      d[i] = detail::central_difference(f[i], f[i + 1], f[i + 2], h[i], h[i + 1]);
+    for(std::size_t i = 0; i < n; i++)
+      out[start + i] = OutUnit(result(d[i]));
+  }
+
+  detail::load(values, 2, f);
+  detail::load_steps(axis, 1, h);
+  out[0] = OutUnit(result((f[1] - f[0]) / h[0]));
+  detail::load(values + size - 2, 2, f);
+  detail::load_steps(axis + size - 2, 1, h);
+  out[size - 1] = OutUnit(result((f[1] - f[0]) / h[0]));
+}
+
+
+template <typename ValueUnit, typename AxisUnit, typename OutUnit>
+void derivative(ValueUnit const* values, std::size_t size, AxisUnit const& step, OutUnit* out)
+{
+  typedef derivative_t<ValueUnit, AxisUnit> result;
+  typedef detail::accumulator_t<typename result::rep> acc;
+
+  if(size < 2)
+  {
+    if(size == 1)
+      out[0] = OutUnit(result(0));
+    return;
+  }
+
+  acc dx = static_cast<acc>(step.count());
+  acc f[detail::blockSize + 2];
+  acc d[detail::blockSize];
+
+  for(std::size_t start = 1; start + 1 < size; start += detail::blockSize)
+  {
+    std::size_t n = std::min(detail::blockSize, size - 1 - start);
+    detail::load(values + start - 1, n + 2, f);
+    for(std::size_t i = 0; i < n; i++)
+      d[i] = (f[i + 2] - f[i]) / (2 * dx);
+    for(std::size_t i = 0; i < n; i++)
+      out[start + i] = OutUnit(result(d[i]));
+  }
+
+  detail::load(values, 2, f);
+  out[0] = OutUnit(result((f[1] - f[0]) / dx));
+  detail::load(values + size - 2, 2, f);
+  out[size - 1] = OutUnit(result((f[1] - f[0]) / dx));
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== CONTAINERS ==============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//containers have data() and size() ; a step is a single unit
+
+template <typename Values, typename Axis>
+auto trapezoid(Values const& values, Axis const& axis) -> decltype(trapezoid(values.data(), axis.data(), values.size()))
+{
+  if(axis.size() != values.size())
+    throw std::length_error("omni::calculus : values and axis have different sizes.");
+  return trapezoid(values.data(), axis.data(), values.size());
+}
+
+
+template <typename Values, typename Dimension, typename Rep, typename Period, double const& Origin>
+auto trapezoid(Values const& values, Unit<Dimension, Rep, Period, Origin> const& step) -> decltype(trapezoid(values.data(), values.size(), step))
+{
+  return trapezoid(values.data(), values.size(), step);
+}
+
+
+template <typename Values, typename Axis>
+auto simpson(Values const& values, Axis const& axis) -> decltype(simpson(values.data(), axis.data(), values.size()))
+{
+  if(axis.size() != values.size())
+    throw std::length_error("omni::calculus : values and axis have different sizes.");
+  return simpson(values.data(), axis.data(), values.size());
+}
+
+
+template <typename Values, typename Dimension, typename Rep, typename Period, double const& Origin>
+auto simpson(Values const& values, Unit<Dimension, Rep, Period, Origin> const& step) -> decltype(simpson(values.data(), values.size(), step))
+{
+  return simpson(values.data(), values.size(), step);
+}
+
+
+template <typename Values, typename Axis, typename Out>
+auto cumulative_trapezoid(Values const& values, Axis const& axis, Out& out) -> decltype(axis.data(), out.data(), void())
+{
+  if(axis.size() != values.size())
+    throw std::length_error("omni::calculus : values and axis have different sizes.");
+  if(out.size() < values.size())
+    throw std::length_error("omni::calculus : output is smaller than input.");
+  cumulative_trapezoid(values.data(), axis.data(), values.size(), out.data());
+}
+
+
+template <typename Values, typename Dimension, typename Rep, typename Period, double const& Origin, typename Out>
+auto cumulative_trapezoid(Values const& values, Unit<Dimension, Rep, Period, Origin> const& step, Out& out) -> decltype(out.data(), void())
+{
+  if(out.size() < values.size())
+    throw std::length_error("omni::calculus : output is smaller than input.");
+  cumulative_trapezoid(values.data(), values.size(), step, out.data());
+}
+
+
+template <typename Values, typename Axis, typename Out>
+auto derivative(Values const& values, Axis const& axis, Out& out) -> decltype(axis.data(), out.data(), void())
+{
+  if(axis.size() != values.size())
+    throw std::length_error("omni::calculus : values and axis have different sizes.");
+  if(out.size() < values.size())
+    throw std::length_error("omni::calculus : output is smaller than input.");
+  derivative(values.data(), axis.data(), values.size(), out.data());
+}
+
+
+template <typename Values, typename Dimension, typename Rep, typename Period, double const& Origin, typename Out>
+auto derivative(Values const& values, Unit<Dimension, Rep, Period, Origin> const& step, Out& out) -> decltype(out.data(), void())
+{
+  if(out.size() < values.size())
+    throw std::length_error("omni::calculus : output is smaller than input.");
+  derivative(values.data(), values.size(), step, out.data());
+}
+
+
+
+} //namespace calculus
+} //namespace omni
+
+
+
+#endif //OMNIUNIT_CALCULUS_HH_
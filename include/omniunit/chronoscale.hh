@@ -36,10 +36,27 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define OMNIUNIT_CHRONOSCALE_HH_
 
 #include "omniunit.hh"
-
-#include <ctime>   // gmtime, localtime, time, tm
+#include "core/kernels.hh"
+
+#include <algorithm>  // upper_bound
+#include <atomic>  // atomic
+#include <cerrno>  // EINTR
+#include <cmath>  // exp
+#include <condition_variable>  // condition_variable
+#include <ctime>   // gmtime, localtime, time, tm, clock_nanosleep
+#include <deque>  // deque
 #include <exception>  // exception
-#include <memory>  // unique_ptr
+#include <functional>  // function
+#include <iterator>  // next
+#include <map>  // map
+#include <memory>  // unique_ptr, shared_ptr, weak_ptr
+#include <mutex>  // unique_lock
+#include <shared_mutex>  // shared_mutex, shared_lock
+#include <stdexcept>  // invalid_argument, logic_error
+#include <thread>  // sleep_until
+#include <utility>  // pair
+#include <unordered_map>  // unordered_map
+#include <vector>  // vector
 
 
 
@@ -92,6 +109,205 @@ public:
 
 
 
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== CLOCK DEFINITION ========================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//clock on which timers and countdowns run
+class Clock
+{
+public:
+
+  typedef std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> time_point;
+
+  virtual ~Clock()
+  {
+  }
+
+  virtual time_point now() const = 0;
+
+  //blocks the calling thread until now() reaches instant
+  virtual void sleepUntil(time_point const& instant) const = 0;
+};
+
+
+
+//default clock, wrapping std::chrono::steady_clock
+class SteadyClock : public Clock
+{
+public:
+
+  virtual time_point now() const
+  {
+    return std::chrono::steady_clock::now();
+  }
+
+
+  //sleeps until a bit before instant, then spins until instant.
+  //The spin margin follows the observed lateness of the sleep.
+  virtual void sleepUntil(time_point const& instant) const
+  {
+    time_point wake = instant - std::chrono::nanoseconds(2 * _lateness.load(std::memory_order_relaxed) + minimumMargin);
+
+    if(wake > now())
+    {
+#if defined(__linux__) // steady_clock is CLOCK_MONOTONIC
+      timespec absolute;
+      absolute.tv_sec = static_cast<time_t>(wake.time_since_epoch().count() / 1000000000);
+      absolute.tv_nsec = static_cast<long>(wake.time_since_epoch().count() % 1000000000);
+      while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &absolute, nullptr) == EINTR)
+      {
+      }
+#else
+      std::this_thread::sleep_until(wake);
+#endif
+      std::chrono::nanoseconds::rep lateness = (now() - wake).count();
+      std::chrono::nanoseconds::rep estimate = _lateness.load(std::memory_order_relaxed);
+      _lateness.store(estimate + (lateness - estimate) / 8, std::memory_order_relaxed);
+    }
+
+    while(now() < instant)
+    {
+    }
+  }
+
+
+  static SteadyClock const& instance()
+  {
+    static SteadyClock const clock;
+    return clock;
+  }
+
+protected:
+
+  //in nanoseconds
+  static constexpr std::chrono::nanoseconds::rep minimumMargin = 5000;
+  //average lateness of the system sleep, in nanoseconds
+  inline static std::atomic<std::chrono::nanoseconds::rep> _lateness{50000};
+};
+
+
+
+//clock which only moves when advance() is called. Callbacks scheduled on it are
+//called in chronological order (then in scheduling order) while advancing, and
+//now() returns the time at which they were scheduled while they run.
+class VirtualClock : public Clock
+{
+public:
+
+  explicit VirtualClock(time_point const& start = time_point()):
+  _now(start.time_since_epoch().count()),
+  _events(),
+  _nextId(0),
+  _mutex(),
+  _moved()
+  {
+  }
+
+
+  virtual time_point now() const
+  {
+    return time_point(std::chrono::nanoseconds(_now.load(std::memory_order_acquire)));
+  }
+
+
+  //returns when another thread advances the clock up to instant
+  virtual void sleepUntil(time_point const& instant) const
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _moved.wait(lock, [this, &instant](){return now() >= instant;});
+  }
+
+
+  template <typename Rep, typename Period, double const& Origin>
+  void advance(Unit<Duration, Rep, Period, Origin> const& duration)
+  {
+    advanceTo(now() + unit_cast<std::chrono::nanoseconds>(duration));
+  }
+
+
+  void advanceTo(time_point const& target)
+  {
+    while(true)
+    {
+      std::function<void()> callback;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_events.empty() || _events.begin()->first.first > target)
+        {
+          if(target > now())
+            _now.store(target.time_since_epoch().count(), std::memory_order_release);
+          _moved.notify_all();
+          return;
+        }
+        if(_events.begin()->first.first > now())
+          _now.store(_events.begin()->first.first.time_since_epoch().count(), std::memory_order_release);
+        callback = std::move(_events.begin()->second);
+        _events.erase(_events.begin());
+      }
+      _moved.notify_all();
+      callback();
+    }
+  }
+
+
+  //returns an id which can be given to cancel()
+  template <typename Rep, typename Period, double const& Origin>
+  unsigned long long schedule(Unit<Duration, Rep, Period, Origin> const& delay, std::function<void()> callback)
+  {
+    return scheduleAt(now() + unit_cast<std::chrono::nanoseconds>(delay), std::move(callback));
+  }
+
+
+  unsigned long long scheduleAt(time_point const& instant, std::function<void()> callback)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _events.emplace(std::make_pair(instant, _nextId), std::move(callback));
+    return _nextId++;
+  }
+
+
+  bool cancel(unsigned long long id)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(std::map<std::pair<time_point, unsigned long long>, std::function<void()>>::iterator it = _events.begin(); it != _events.end(); ++it)
+    {
+      if(it->first.second == id)
+      {
+        _events.erase(it);
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  std::size_t pending() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _events.size();
+  }
+
+
+protected:
+
+  std::atomic<std::chrono::nanoseconds::rep> _now;
+  //events are sorted by instant, then by id
+  std::map<std::pair<time_point, unsigned long long>, std::function<void()>> _events;
+  unsigned long long _nextId;
+  mutable std::mutex _mutex;
+  //notified each time the clock moves
+  mutable std::condition_variable _moved;
+};
+
+
+
 //=============================================================================
 //=============================================================================
 //=============================================================================
@@ -108,8 +324,9 @@ public:
 
   friend class Countdown;
 
-  explicit Timer() :
-  _Begin(std::chrono::steady_clock::now()),
+  explicit Timer(Clock const& clock = SteadyClock::instance()) :
+  _clock(&clock),
+  _Begin(_clock->now()),
   _BeginPause(_Begin),
   _PausedTime(0),
   _addedTime(0),
@@ -118,6 +335,11 @@ public:
   }
 
 
+  //the clock is shared, not copied
+  Timer(Timer const&) = default;
+  Timer& operator=(Timer const&) = default;
+
+
   virtual ~Timer()
   {
   }
@@ -134,7 +356,7 @@ public:
   {
     if(_state == State::paused)
     {
-      _PausedTime += (std::chrono::steady_clock::now() - _BeginPause);
+      _PausedTime += (_clock->now() - _BeginPause);
       _state = State::active;
     }
     if(_state == State::stopped)
@@ -146,15 +368,15 @@ public:
   {
     if(_state == State::active)
     {
-      _BeginPause = std::chrono::steady_clock::now();
+      _BeginPause = _clock->now();
       _state = State::paused;
     }
   }
 
 
-  void stop()
+  virtual void stop()
   {
-    _Begin = std::chrono::steady_clock::now();
+    _Begin = _clock->now();
     _PausedTime = std::chrono::nanoseconds::zero();
     clear();
     _state = State::stopped;
@@ -201,13 +423,15 @@ protected:
   virtual std::chrono::nanoseconds getNano() const
   {
     std::chrono::nanoseconds CurrentPausedTime = std::chrono::nanoseconds::zero();
-    std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> Now = std::chrono::steady_clock::now();
+    std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> Now = _clock->now();
     if(_state == State::paused)
       CurrentPausedTime = Now - _BeginPause;
     return ((Now - _Begin) - (_PausedTime + CurrentPausedTime) + _addedTime);
 
   }
 
+  //clock on which the timer runs (not owned)
+  Clock const* _clock;
   //Point of the first start() following the last stop
   std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> _Begin;
   //Point of last pause
@@ -263,24 +487,24 @@ class Countdown
 {
 public:
 
-  explicit Countdown() :
-   _End(std::chrono::steady_clock::now()),
-   _Timer(std::make_unique<Timer>())
+  explicit Countdown(Clock const& clock = SteadyClock::instance()) :
+   _End(clock.now()),
+   _Timer(std::make_unique<Timer>(clock))
    {
    }
 
 
   template <typename Rep, typename Period, double const& Origin>
-  explicit Countdown(Unit<Duration, Rep, Period, Origin> const& duration) :
-  _End(std::chrono::steady_clock::now() + duration),
-  _Timer(std::make_unique<Timer>())
+  explicit Countdown(Unit<Duration, Rep, Period, Origin> const& duration, Clock const& clock = SteadyClock::instance()) :
+  _End(clock.now() + unit_cast<std::chrono::nanoseconds>(duration)),
+  _Timer(std::make_unique<Timer>(clock))
   {
   }
 
 
-  explicit Countdown(std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> const& timpoint) :
+  explicit Countdown(std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> const& timpoint, Clock const& clock = SteadyClock::instance()) :
   _End(timpoint),
-  _Timer(std::make_unique<Timer>())
+  _Timer(std::make_unique<Timer>(clock))
   {
   }
 
@@ -289,7 +513,7 @@ protected:
 
   //these constructor is only accessible to RelativeCountdown
   explicit Countdown(Timer const& tim) :
-   _End(std::chrono::steady_clock::now()),
+   _End(tim._clock->now()),
    _Timer(std::make_unique<Timer>(tim))
    {
    }
@@ -297,7 +521,7 @@ protected:
 
   template <typename Rep, typename Period, double const& Origin>
   explicit Countdown(Unit<Duration, Rep, Period, Origin> const& duration, Timer const& tim) :
-  _End(std::chrono::steady_clock::now() + duration),
+  _End(tim._clock->now() + unit_cast<std::chrono::nanoseconds>(duration)),
   _Timer(std::make_unique<Timer>(tim))
   {
   }
@@ -351,16 +575,80 @@ public:
   void reset()
   {
     _Timer->pause();
-    _End = std::chrono::steady_clock::now();
+    _End = _Timer->_clock->now();
     _Timer->_Begin = _End;
   }
 
+  //blocks until the countdown expires, and returns how late it returned.
+  //On a SteadyClock, the thread sleeps then spins for the last microseconds.
+  //A paused countdown never expires : waiting for it throws std::logic_error.
+  template<typename durationType = nanosecond<long long>>
+  durationType wait() const
+  {
+    std::chrono::nanoseconds left = getNano();
+    while(left > std::chrono::nanoseconds::zero())
+    {
+      if(paused())
+        throw std::logic_error("omni::Countdown::wait : the countdown is paused.");
+      _Timer->_clock->sleepUntil(_Timer->_clock->now() + left);
+      left = getNano();
+    }
+    return unit_cast<durationType>(-left);
+  }
+
+  //blocks until one of the countdowns expires, and returns its index and how late it returned.
+  //All countdowns should run on the same clock. Paused countdowns are only returned if they
+  //have already expired : if all of them are paused, wait_any throws std::logic_error.
+  template<typename durationType = nanosecond<long long>, typename container_t>
+  static std::pair<std::size_t, durationType> wait_any(container_t const& countdowns)
+  {
+    if(std::begin(countdowns) == std::end(countdowns))
+      throw std::invalid_argument("omni::Countdown::wait_any : no countdown to wait for.");
+
+    while(true)
+    {
+      std::size_t index = 0;
+      std::size_t first = 0;
+      std::chrono::nanoseconds left = std::chrono::nanoseconds::max();
+      //earliest running countdown, the one to sleep for
+      std::chrono::nanoseconds sleep = std::chrono::nanoseconds::max();
+      Countdown const* earliest = nullptr;
+
+      for(Countdown const& countdown : countdowns)
+      {
+        std::chrono::nanoseconds current = countdown.getNano();
+        if(current < left)
+        {
+          left = current;
+          first = index;
+        }
+        if(current < sleep && !countdown.paused())
+        {
+          sleep = current;
+          earliest = &countdown;
+        }
+        index++;
+      }
+
+      if(left <= std::chrono::nanoseconds::zero())
+        return std::make_pair(first, unit_cast<durationType>(-left));
+      if(earliest == nullptr)
+        throw std::logic_error("omni::Countdown::wait_any : every countdown is paused.");
+      earliest->_Timer->_clock->sleepUntil(earliest->_Timer->_clock->now() + sleep);
+    }
+  }
+
 protected:
   std::chrono::nanoseconds getNano() const
   {
     return (_End - _Timer->_Begin) - _Timer->getNano();
   }
 
+  bool paused() const
+  {
+    return _Timer->_state == Timer::State::paused;
+  }
+
   std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> _End;
   //_Timer is a pointer in order to use polymorphism (with RelativeTimer)
   std::unique_ptr<Timer> _Timer;
@@ -404,7 +692,8 @@ class RelativeTimer : public Timer
 {
 public:
 
-  RelativeTimer(double gamma):
+  RelativeTimer(double gamma, Clock const& clock = SteadyClock::instance()):
+  Timer(clock),
   _gamma(gamma)
   {
   }
@@ -435,10 +724,536 @@ protected:
 class RelativeCountdown : public Countdown
 {
 public:
-  RelativeCountdown(double gamma):
-  Countdown(RelativeTimer(gamma))
+  RelativeCountdown(double gamma, Clock const& clock = SteadyClock::instance()):
+  Countdown(RelativeTimer(gamma, clock))
+  {
+  }
+};
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== SCALABLE TIMER DEFINITION ===============================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//the flow rate of a ScalableTimer can be changed at any moment without losing
+//continuity. Each rate change opens a new segment storing where it begins (in
+//unscaled elapsed time), its rate and the scaled time already elapsed when it
+//begins, so that get() only needs a binary search over the segments.
+//setRate() may be called while other threads call get().
+class ScalableTimer : public Timer
+{
+public:
+
+  explicit ScalableTimer(double rate = 1., Clock const& clock = SteadyClock::instance()):
+  Timer(clock),
+  _segments(1, Segment{std::chrono::nanoseconds::zero(), rate, std::chrono::nanoseconds::zero()}),
+  _mutex()
+  {
+  }
+
+
+  void setRate(double rate)
+  {
+    std::chrono::nanoseconds elapsed = Timer::getNano();
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+
+    //elapsed time can go backward through operator-=, forget the segments it goes through
+    std::vector<Segment>::iterator it = find(elapsed);
+    std::chrono::nanoseconds scaled = scale(*it, elapsed);
+    _segments.erase(it + 1, _segments.end());
+
+    if(elapsed <= it->begin)
+      *it = Segment{it->begin, rate, it->scaled};
+    else
+      _segments.push_back(Segment{elapsed, rate, scaled});
+  }
+
+
+  double rate() const
+  {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _segments.back().rate;
+  }
+
+
+  virtual void stop()
+  {
+    Timer::stop();
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    _segments.front() = Segment{std::chrono::nanoseconds::zero(), _segments.back().rate, std::chrono::nanoseconds::zero()};
+    _segments.erase(_segments.begin() + 1, _segments.end());
+  }
+
+
+protected:
+
+  struct Segment
+  {
+    //unscaled elapsed time at which the segment begins
+    std::chrono::nanoseconds begin;
+    double rate;
+    //scaled elapsed time at which the segment begins
+    std::chrono::nanoseconds scaled;
+  };
+
+
+  virtual std::chrono::nanoseconds getNano() const
+  {
+    std::chrono::nanoseconds elapsed = Timer::getNano();
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return scale(*find(elapsed), elapsed);
+  }
+
+
+  //last segment beginning before elapsed (or the first one)
+  std::vector<Segment>::iterator find(std::chrono::nanoseconds const& elapsed)
+  {
+    std::vector<Segment>::iterator it = std::upper_bound(_segments.begin(), _segments.end(), elapsed,
+    [](std::chrono::nanoseconds const& time, Segment const& segment){return time < segment.begin;});
+    return (it == _segments.begin() ? it : it - 1);
+  }
+
+
+  std::vector<Segment>::const_iterator find(std::chrono::nanoseconds const& elapsed) const
+  {
+    std::vector<Segment>::const_iterator it = std::upper_bound(_segments.begin(), _segments.end(), elapsed,
+    [](std::chrono::nanoseconds const& time, Segment const& segment){return time < segment.begin;});
+    return (it == _segments.begin() ? it : it - 1);
+  }
+
+
+  static std::chrono::nanoseconds scale(Segment const& segment, std::chrono::nanoseconds const& elapsed)
+  {
+    return segment.scaled + std::chrono::nanoseconds(
+    std::llround(static_cast<double>((elapsed - segment.begin).count()) * segment.rate));
+  }
+
+
+  std::vector<Segment> _segments;
+  mutable std::shared_mutex _mutex;
+};
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== CONCURRENT TIMER DEFINITION =============================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//Timer which can be read from any number of threads while it is controlled.
+//Control operations publish the state through a sequence lock : readers never
+//take a lock and never block the control thread, they just retry if the state
+//changed while they were reading it. Control operations are serialized.
+class ConcurrentTimer
+{
+public:
+
+  explicit ConcurrentTimer(Clock const& clock = SteadyClock::instance()) :
+  _clock(&clock),
+  _sequence(0),
+  _Begin(clock.now().time_since_epoch().count()),
+  _BeginPause(_Begin.load(std::memory_order_relaxed)),
+  _PausedTime(0),
+  _addedTime(0),
+  _state(State::stopped),
+  _control()
+  {
+  }
+
+
+  ConcurrentTimer(ConcurrentTimer const&) = delete;
+  ConcurrentTimer& operator=(ConcurrentTimer const&) = delete;
+
+
+  virtual ~ConcurrentTimer()
+  {
+  }
+
+
+  template<typename durationType = second<long long>>
+  durationType get() const
+  {
+    return omni::unit_cast<durationType>(getNano());
+  }
+
+
+  void start()
+  {
+    std::lock_guard<std::mutex> lock(_control);
+    State state = _state.load(std::memory_order_relaxed);
+    if(state == State::paused)
+    {
+      rep paused = _PausedTime.load(std::memory_order_relaxed) + now() - _BeginPause.load(std::memory_order_relaxed);
+      beginWrite();
+      _PausedTime.store(paused, std::memory_order_relaxed);
+      _state.store(State::active, std::memory_order_relaxed);
+      endWrite();
+    }
+    if(state == State::stopped)
+    {
+      beginWrite();
+      _state.store(State::active, std::memory_order_relaxed);
+      endWrite();
+    }
+  }
+
+
+  void pause()
+  {
+    std::lock_guard<std::mutex> lock(_control);
+    if(_state.load(std::memory_order_relaxed) == State::active)
+    {
+      rep beginPause = now();
+      beginWrite();
+      _BeginPause.store(beginPause, std::memory_order_relaxed);
+      _state.store(State::paused, std::memory_order_relaxed);
+      endWrite();
+    }
+  }
+
+
+  void stop()
   {
+    std::lock_guard<std::mutex> lock(_control);
+    rep begin = now();
+    beginWrite();
+    _Begin.store(begin, std::memory_order_relaxed);
+    _PausedTime.store(0, std::memory_order_relaxed);
+    _addedTime.store(0, std::memory_order_relaxed);
+    _state.store(State::stopped, std::memory_order_relaxed);
+    endWrite();
   }
+
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_control);
+    beginWrite();
+    _addedTime.store(0, std::memory_order_relaxed);
+    endWrite();
+  }
+
+
+  void reset()
+  {
+    stop();
+    start();
+  }
+
+
+  template <typename Rep, typename Period, double const& Origin>
+  ConcurrentTimer& operator+=(Unit<Duration, Rep, Period, Origin> const& duration)
+  {
+    std::lock_guard<std::mutex> lock(_control);
+    rep added = _addedTime.load(std::memory_order_relaxed) + unit_cast<std::chrono::nanoseconds>(duration).count();
+    beginWrite();
+    _addedTime.store(added, std::memory_order_relaxed);
+    endWrite();
+    return *this;
+  }
+
+
+  template <typename Rep, typename Period, double const& Origin>
+  ConcurrentTimer& operator-=(Unit<Duration, Rep, Period, Origin> const& duration)
+  {
+    std::lock_guard<std::mutex> lock(_control);
+    rep removed = std::min(unit_cast<std::chrono::nanoseconds>(duration).count(), elapsed(snapshot()));
+    rep added = _addedTime.load(std::memory_order_relaxed) - removed;
+    beginWrite();
+    _addedTime.store(added, std::memory_order_relaxed);
+    endWrite();
+    return *this;
+  }
+
+
+protected:
+
+  enum class State {active, paused, stopped};
+  typedef std::chrono::nanoseconds::rep rep;
+
+  //consistent copy of the published state
+  struct Snapshot
+  {
+    rep begin;
+    rep beginPause;
+    rep pausedTime;
+    rep addedTime;
+    State state;
+  };
+
+
+  rep now() const
+  {
+    return _clock->now().time_since_epoch().count();
+  }
+
+
+  //an odd sequence number means a write is in progress
+  void beginWrite()
+  {
+    _sequence.store(_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+
+  void endWrite()
+  {
+    _sequence.store(_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+
+  Snapshot snapshot() const
+  {
+    Snapshot snap{0, 0, 0, 0, State::stopped};
+    unsigned long long before = 0;
+    unsigned long long after = 0;
+    do
+    {
+      before = _sequence.load(std::memory_order_acquire);
+      snap.begin = _Begin.load(std::memory_order_relaxed);
+      snap.beginPause = _BeginPause.load(std::memory_order_relaxed);
+      snap.pausedTime = _PausedTime.load(std::memory_order_relaxed);
+      snap.addedTime = _addedTime.load(std::memory_order_relaxed);
+      snap.state = _state.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = _sequence.load(std::memory_order_relaxed);
+    } while((before & 1) != 0 || before != after);
+    return snap;
+  }
+
+
+  rep elapsed(Snapshot const& snap) const
+  {
+    rep Now = now();
+    rep CurrentPausedTime = (snap.state == State::paused ? Now - snap.beginPause : 0);
+    return (Now - snap.begin) - (snap.pausedTime + CurrentPausedTime) + snap.addedTime;
+  }
+
+
+  std::chrono::nanoseconds getNano() const
+  {
+    return std::chrono::nanoseconds(elapsed(snapshot()));
+  }
+
+
+  //clock on which the timer runs (not owned)
+  Clock const* _clock;
+  std::atomic<unsigned long long> _sequence;
+  //same meaning as in Timer, in nanoseconds since the clock epoch
+  std::atomic<rep> _Begin;
+  std::atomic<rep> _BeginPause;
+  std::atomic<rep> _PausedTime;
+  std::atomic<rep> _addedTime;
+  std::atomic<State> _state;
+  //serializes control operations, never taken by readers
+  std::mutex _control;
+};
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== RATE METER DEFINITION ===================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//Counts events from any number of threads and reports their rate.
+//Each thread counts in its own cache line, so mark() never writes to a cache
+//line shared with another thread. Rates are computed when they are read :
+//- instant() is the rate since the previous read,
+//- windowed() is the rate over (at least) the last window,
+//- ewma() is the rate exponentially averaged with the decay time constant.
+class RateMeter
+{
+public:
+
+  template <typename Rep1, typename Period1, double const& Origin1,
+            typename Rep2, typename Period2, double const& Origin2>
+  explicit RateMeter(Unit<Duration, Rep1, Period1, Origin1> const& window,
+  Unit<Duration, Rep2, Period2, Origin2> const& decay, Clock const& clock = SteadyClock::instance()) :
+  _clock(&clock),
+  _id(nextId()),
+  _alive(std::make_shared<bool>(true)),
+  _window(unit_cast<std::chrono::nanoseconds>(window)),
+  _decay(unit_cast<std::chrono::nanoseconds>(decay)),
+  _slots(),
+  _slotsMutex(),
+  _samples(1, Sample{clock.now(), 0}),
+  _instant(0.),
+  _ewma(0.),
+  _readMutex()
+  {
+  }
+
+
+  RateMeter(RateMeter const&) = delete;
+  RateMeter& operator=(RateMeter const&) = delete;
+
+
+  virtual ~RateMeter()
+  {
+  }
+
+
+  //only the calling thread writes to its counter, no atomic read-modify-write is needed
+  void mark(unsigned long long events = 1)
+  {
+    std::atomic<unsigned long long>& counter = slot().count;
+    counter.store(counter.load(std::memory_order_relaxed) + events, std::memory_order_relaxed);
+  }
+
+
+  //total number of events
+  unsigned long long count() const
+  {
+    std::lock_guard<std::mutex> lock(_slotsMutex);
+    unsigned long long total = 0;
+    for(std::unique_ptr<Slot> const& counter : _slots)
+      total += counter->count.load(std::memory_order_relaxed);
+    return total;
+  }
+
+
+  template<typename frequencyType = hertz<>>
+  frequencyType instant()
+  {
+    std::lock_guard<std::mutex> lock(_readMutex);
+    sample();
+    return frequencyType(hertz<double>(_instant));
+  }
+
+
+  template<typename frequencyType = hertz<>>
+  frequencyType windowed()
+  {
+    std::lock_guard<std::mutex> lock(_readMutex);
+    Sample const& last = sample();
+    Sample const& first = _samples.front();
+    if(last.time <= first.time)
+      return frequencyType(hertz<double>(_instant));
+    return frequencyType(hertz<double>(rate(first, last)));
+  }
+
+
+  template<typename frequencyType = hertz<>>
+  frequencyType ewma()
+  {
+    std::lock_guard<std::mutex> lock(_readMutex);
+    sample();
+    return frequencyType(hertz<double>(_ewma));
+  }
+
+
+protected:
+
+  struct alignas(kernel_detail::cacheLine) Slot
+  {
+    std::atomic<unsigned long long> count;
+  };
+
+  struct Sample
+  {
+    Clock::time_point time;
+    unsigned long long count;
+  };
+
+  //slot of a thread in a meter, valid as long as the meter is alive
+  struct Entry
+  {
+    std::weak_ptr<bool> meter;
+    Slot* slot;
+  };
+
+
+  //meters are identified by an id rather than by their address, which can be reused
+  static unsigned long long nextId()
+  {
+    static std::atomic<unsigned long long> id(0);
+    return id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+
+  //entries of destroyed meters are pruned when the thread marks a new meter
+  Slot& slot()
+  {
+    thread_local std::unordered_map<unsigned long long, Entry> slots;
+    std::unordered_map<unsigned long long, Entry>::iterator it = slots.find(_id);
+    if(it != slots.end())
+      return *it->second.slot;
+
+    for(it = slots.begin(); it != slots.end();)
+      it = it->second.meter.expired() ? slots.erase(it) : std::next(it);
+
+    std::lock_guard<std::mutex> lock(_slotsMutex);
+    _slots.push_back(std::make_unique<Slot>());
+    _slots.back()->count.store(0, std::memory_order_relaxed);
+    slots.emplace(_id, Entry{_alive, _slots.back().get()});
+    return *_slots.back();
+  }
+
+
+  static double rate(Sample const& first, Sample const& last)
+  {
+    return static_cast<double>(last.count - first.count) /
+    std::chrono::duration<double>(last.time - first.time).count();
+  }
+
+
+  //records the current count and updates the instant and averaged rates
+  Sample const& sample()
+  {
+    Sample last{_clock->now(), count()};
+    Sample const& previous = _samples.back();
+
+    if(last.time > previous.time)
+    {
+      _instant = rate(previous, last);
+      double alpha = 1. - std::exp(-std::chrono::duration<double>(last.time - previous.time).count()
+      / std::chrono::duration<double>(_decay).count());
+      _ewma += alpha * (_instant - _ewma);
+      _samples.push_back(last);
+    }
+
+    //keep the last sample older than the window, it is the beginning of the window
+    while(_samples.size() > 1 && _samples[1].time <= _samples.back().time - _window)
+      _samples.pop_front();
+
+    return _samples.back();
+  }
+
+
+  //clock on which the meter runs (not owned)
+  Clock const* _clock;
+  unsigned long long const _id;
+  //expires with the meter, so that threads can drop their entry
+  std::shared_ptr<bool> const _alive;
+  std::chrono::nanoseconds const _window;
+  std::chrono::nanoseconds const _decay;
+  //one counter per thread which marked events
+  std::vector<std::unique_ptr<Slot>> _slots;
+  mutable std::mutex _slotsMutex;
+  //counts read by previous calls, oldest first
+  std::deque<Sample> _samples;
+  //in hertz
+  double _instant;
+  double _ewma;
+  std::mutex _readMutex;
 };
 
 
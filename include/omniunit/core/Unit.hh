@@ -38,7 +38,25 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define OMNIUNIT_UNIT_HH_
 
 
+#include "../settings.hh"
+
+#if OMNI_USE_SAME_TYPE_FOR_UNCERTAINTIES
+  #define OMNI_UTYPE typename uncertainty_rep<Rep>::type
+  #define OMNI_UTYPE1 typename uncertainty_rep<Rep1>::type
+  #define OMNI_UTYPE2 typename uncertainty_rep<Rep2>::type
+  #define OMNI_UTYPE_ typename uncertainty_rep<_Rep>::type
+  #define OMNI_UTYPE_COMMON typename uncertainty_rep<common>::type
+#else
+  #define OMNI_UTYPE OMNI_DEFAULT_UNCERTAINTY_TYPE
+  #define OMNI_UTYPE1 OMNI_DEFAULT_UNCERTAINTY_TYPE
+  #define OMNI_UTYPE2 OMNI_DEFAULT_UNCERTAINTY_TYPE
+  #define OMNI_UTYPE_ OMNI_DEFAULT_UNCERTAINTY_TYPE
+  #define OMNI_UTYPE_COMMON OMNI_DEFAULT_UNCERTAINTY_TYPE
+#endif //OMNI_USE_SAME_TYPE_FOR_UNCERTAINTIES
+
 #include "utility.hh"
+#include "integer.hh"
+#include "float16.hh"
 #include "student_quantile.hh"
 
 #include <chrono>
@@ -78,48 +96,147 @@ struct is_Unit<Unit<Dimension, Rep, Period, Origin>> : public std::true_type
 };
 
 
+//types which can be the Rep of a Unit
+template<typename T>
+struct is_rep : public std::integral_constant<bool, std::is_arithmetic<T>::value || is_Integer<T>::value || is_Float16<T>::value>
+{
+};
+
+
+//conversion between integer representations : when num, den and offset are integers,
+//it is computed in integers, exact up to a single rounding of the division. A result
+//which does not fit is handled by the overflow policy (see integer.hh).
+//num, den and offset are constants after inlining, so only one of the three paths remains.
+template<typename toRep, typename common, Overflow policy>
+constexpr toRep convert_integer(common count, double num, double den, double offset, Rounding rounding)
+{
+  constexpr long double limit = 9223372036854775808.0L; //2^63
+  bool countFits = !std::is_unsigned<common>::value || static_cast<std::uintmax_t>(count) <= static_cast<std::uintmax_t>(std::numeric_limits<std::intmax_t>::max());
+
+  //same scale and same origin
+  if(num <= 1 && num >= 1 && den <= 1 && den >= 1 && offset <= 0 && offset >= 0)
+    return integer_cast<toRep, policy>(count);
+
+  //exact path, in intmax_t : count = whole * den + part with 0 <= part < den, so that
+  //count * num / den = whole * num + part * num / den, where part * num cannot overflow
+  if(countFits && math::trunc(num) <= num && math::trunc(num) >= num
+  && math::trunc(den) <= den && math::trunc(den) >= den && static_cast<long double>(num) * static_cast<long double>(den) < limit
+  && math::trunc(offset) <= offset && math::trunc(offset) >= offset && math::abs(offset) < limit)
+  {
+    std::intmax_t factor = static_cast<std::intmax_t>(num);
+    std::intmax_t divisor = static_cast<std::intmax_t>(den);
+    std::intmax_t whole = static_cast<std::intmax_t>(count) / divisor;
+    std::intmax_t part = static_cast<std::intmax_t>(count) % divisor;
+    if(part < 0)
+    {
+      part += divisor;
+      --whole;
+    }
+    part *= factor;
+
+    //nothing to check : computed modulo 2^N, like the unchecked conversion
+    if constexpr(policy == Overflow::Wrap)
+    {
+      std::uintmax_t result = static_cast<std::uintmax_t>(whole) * static_cast<std::uintmax_t>(factor) + static_cast<std::uintmax_t>(part / divisor);
+      if(rounds_up(is_negative(static_cast<std::intmax_t>(result)), part % divisor, divisor, rounding))
+        ++result;
+      return static_cast<toRep>(result + static_cast<std::uintmax_t>(static_cast<std::intmax_t>(offset)));
+    }
+
+    std::intmax_t result = 0;
+    bool upward = !is_negative(whole);
+    bool overflow = multiply_overflow(whole, factor, result);
+    overflow |= add_overflow(result, part / divisor, result);
+    overflow |= add_overflow(result, static_cast<std::intmax_t>(rounds_up(is_negative(result), part % divisor, divisor, rounding)), result);
+    if(add_overflow(result, static_cast<std::intmax_t>(offset), result))
+    {
+      overflow = true;
+      upward = offset > 0;
+    }
+    return overflow ? overflowed<policy>(static_cast<toRep>(result), upward) : integer_cast<toRep, policy>(result);
+  }
+
+  //factors out of integer range, or fractional offset (celsius) : computed in long double
+  return integer_cast<toRep, policy>(round_value(static_cast<long double>(count) * static_cast<long double>(num) / static_cast<long double>(den) + static_cast<long double>(offset), rounding));
+}
+
+
+//conversion kernel : every cast between two units is count * num / den + offset.
+//It only depends on the representations, so that the code is shared by all units
+//having the same Rep, whatever their Period and Origin (num, den and offset are
+//given by Conversion at compile time).
+template<typename toRep, typename common>
+constexpr toRep convert_count(common count, double num, double den, double offset, Rounding rounding = Rounding::OMNI_INTEGER_ROUNDING)
+{
+  if constexpr(is_integer_rep<toRep>::value && is_integer_rep<common>::value)
+  {
+    //the policy of an Integer destination wins
+    typedef typename std::conditional<is_Integer<toRep>::value, integer_traits<toRep>, integer_traits<common>>::type traits;
+    return static_cast<toRep>(convert_integer<typename integer_traits<toRep>::type, typename integer_traits<common>::type, traits::overflow>(
+      integer_traits<common>::value(count), num, den, offset, rounding));
+  }
+  else
+  {
+    static_cast<void>(rounding);
+    return static_cast<toRep>((count * static_cast<common>(num) / static_cast<common>(den)) + static_cast<common>(offset));
+  }
+}
+
+
+//constants converting a count of fromUnit into a count of toUnit
+template<typename fromUnit, typename toUnit>
+struct Conversion
+{
+private:
+  typedef typename Ratio_over_Ratio<typename fromUnit::period, typename toUnit::period>::type ratio;
+
+public:
+  static constexpr double num = ratio::num;
+  static constexpr double den = ratio::den;
+  static constexpr double offset = (fromUnit::origin - toUnit::origin) / toUnit::period::value;
+};
+
+
 //true cast, modifying the input parameter to a toUnit
 template<typename toUnit, typename Dimension, typename Rep, typename Period, double const& Origin,
 typename = typename std::enable_if<is_Unit<toUnit>::value, toUnit>::type>
-constexpr toUnit unit_cast(const Unit<Dimension, Rep, Period, Origin>& Obj)
+constexpr toUnit unit_cast(const Unit<Dimension, Rep, Period, Origin>& Obj, Rounding rounding = Rounding::OMNI_INTEGER_ROUNDING)
 {
   static_assert(std::is_same<typename toUnit::dim, Dimension>::value, "Cannot cast different dimensions.");
 
-  typedef typename Ratio_over_Ratio<Period, typename toUnit::period>::type new_Ratio;
   typedef typename std::common_type<typename toUnit::rep, Rep>::type common;
+  typedef OMNI_UTYPE_COMMON ucommon;
+  typedef Conversion<Unit<Dimension, Rep, Period, Origin>, toUnit> conv;
 
-  return toUnit(static_cast<typename toUnit::rep>((static_cast<common>(Obj.count())
-    * static_cast<common>(new_Ratio::num) / static_cast<common>(new_Ratio::den))
-    + static_cast<common>((Origin - toUnit::origin) / toUnit::period::value)),
-    static_cast<typename toUnit::rep>((static_cast<OMNI_UTYPE_COMMON>(Obj.absolute())
-    * static_cast<OMNI_UTYPE_COMMON>(new_Ratio::num) / static_cast<OMNI_UTYPE_COMMON>(new_Ratio::den))));
+  return toUnit(convert_count<typename toUnit::rep, common>(static_cast<common>(Obj.count()), conv::num, conv::den, conv::offset, rounding),
+    convert_count<typename toUnit::rep, ucommon>(static_cast<ucommon>(Obj.absolute()), conv::num, conv::den, 0., rounding));
     //origin has no impact on uncertainty
 }
 
 
 //modify the Rep of the input parameter
 template<typename T, typename Dimension, typename Rep, typename Period, double const& Origin,
-typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type>
-constexpr Unit<Dimension, T, Period, Origin> unit_cast(const Unit<Dimension, Rep, Period, Origin>& Obj)
+typename = typename std::enable_if<is_rep<T>::value, T>::type>
+constexpr Unit<Dimension, T, Period, Origin> unit_cast(const Unit<Dimension, Rep, Period, Origin>& Obj, Rounding rounding = Rounding::OMNI_INTEGER_ROUNDING)
 {
-  return unit_cast<Unit<Dimension, T, Period, Origin>>(Obj);
+  return unit_cast<Unit<Dimension, T, Period, Origin>>(Obj, rounding);
 }
 
 
 //modify the Ratio of the input parameter
 template<typename R, typename Dimension, typename Rep, typename Period, double const& Origin,
 typename = typename std::enable_if<is_stb_Ratio<R>::value, R>::type>
-constexpr Unit<Dimension, Rep, R, Origin> unit_cast(const Unit<Dimension, Rep, Period, Origin>& Obj)
+constexpr Unit<Dimension, Rep, R, Origin> unit_cast(const Unit<Dimension, Rep, Period, Origin>& Obj, Rounding rounding = Rounding::OMNI_INTEGER_ROUNDING)
 {
-  return unit_cast<Unit<Dimension, Rep, R, Origin>>(Obj);
+  return unit_cast<Unit<Dimension, Rep, R, Origin>>(Obj, rounding);
 }
 
 
 //modify the Origin of the input parameter
 template<double const& O, typename Dimension, typename Rep, typename Period, double const& Origin>
-constexpr Unit<Dimension, Rep, Period, O> unit_cast(const Unit<Dimension, Rep, Period, Origin>& Obj)
+constexpr Unit<Dimension, Rep, Period, O> unit_cast(const Unit<Dimension, Rep, Period, Origin>& Obj, Rounding rounding = Rounding::OMNI_INTEGER_ROUNDING)
 {
-  return unit_cast<Unit<Dimension, Rep, Period, O>>(Obj);
+  return unit_cast<Unit<Dimension, Rep, Period, O>>(Obj, rounding);
 }
 
 
@@ -224,7 +341,7 @@ public:
   //const keyword is needed because we can't assign double& to const double (const qualifier would be lost)
 
   static_assert(is_Dimension<_Dimension>::value, "First template argument sould be a dimension.");
-  static_assert(std::is_arithmetic<Rep>::value, "Second template argument should be an arithmetic type.");
+  static_assert(is_rep<Rep>::value, "Second template argument should be an arithmetic type, an Integer or a Float16.");
   static_assert(is_stb_Ratio<Period>::value, "Third template argument should be an OmniUnit ratio.");
 
   //default constructor
@@ -235,7 +352,7 @@ public:
 
 
   //constructor taking an arithmetic, and uncertainty = 0
-  template<typename _Rep, typename = typename std::enable_if<(std::is_arithmetic<_Rep>::value), _Rep>::type>
+  template<typename _Rep, typename = typename std::enable_if<(is_rep<_Rep>::value), _Rep>::type>
   constexpr Unit(_Rep const& countArg):
   _count(static_cast<Rep>(countArg)), _uncertainty(static_cast<OMNI_UTYPE>(0.))
   {
@@ -243,7 +360,7 @@ public:
 
 
   //constructor taking two arithmetics (overload needed because _RepU cannot be deduced from default parameter)
-  template<typename _RepC, typename _RepU, typename = typename std::enable_if<(std::is_arithmetic<_RepC>::value && std::is_arithmetic<_RepU>::value), _RepC>::type>
+  template<typename _RepC, typename _RepU, typename = typename std::enable_if<(is_rep<_RepC>::value && is_rep<_RepU>::value), _RepC>::type>
   constexpr Unit(_RepC const& countArg, _RepU const& uncertaintyArg):
   _count(static_cast<Rep>(countArg)), _uncertainty(static_cast<OMNI_UTYPE>(uncertaintyArg))
   {
@@ -253,7 +370,7 @@ public:
   // copy constructor
   template<typename _Rep, typename _Period, double const& _Origin>
   constexpr Unit(Unit<dim, _Rep, _Period, _Origin> const& Obj):
-  Unit(unit_cast<Unit, dim>(Obj).count(), unit_cast<Unit, dim>(Obj).absolute())
+  Unit(unit_cast<Unit, dim>(Obj))
   {
   }
 
@@ -285,7 +402,7 @@ public:
 
 
   // constructor taking a container
-  template<typename container_t, typename = typename std::enable_if<(!std::is_arithmetic<container_t>::value), container_t>::type, typename>
+  template<typename container_t, typename = typename std::enable_if<(!is_rep<container_t>::value), container_t>::type, typename>
   constexpr Unit(container_t const& Obj):
   Unit(getMeanAndDeviation(Obj, 0))
   {
@@ -293,7 +410,7 @@ public:
 
 
   // constructor taking a container and an arithmetic (here, the arithmetic is the systematic error, not the uncertainty)
-  template<typename container_t, typename _RepSyst, typename = typename std::enable_if<(std::is_arithmetic<_RepSyst>::value), _RepSyst>::type, typename = typename std::enable_if<(!std::is_arithmetic<container_t>::value), container_t>::type>
+  template<typename container_t, typename _RepSyst, typename = typename std::enable_if<(std::is_arithmetic<_RepSyst>::value), _RepSyst>::type, typename = typename std::enable_if<(!is_rep<container_t>::value), container_t>::type>
   constexpr Unit(container_t const& Obj, _RepSyst const& systematicError):
   Unit(getMeanAndDeviation(Obj, systematicError))
   {
@@ -376,25 +493,29 @@ public:
 
   Unit ceil(unsigned decimal = 1)
   {
-    _count = static_cast<Rep>(std::ceil(_count * decimal)) / static_cast<Rep>(decimal);
+    _count = static_cast<Rep>(std::ceil(_count * static_cast<Rep>(decimal))) / static_cast<Rep>(decimal);
+    return *this;
   }
 
 
   Unit floor(unsigned decimal = 1)
   {
-    _count = static_cast<Rep>(std::floor(_count * decimal)) / static_cast<Rep>(decimal);
+    _count = static_cast<Rep>(std::floor(_count * static_cast<Rep>(decimal))) / static_cast<Rep>(decimal);
+    return *this;
   }
 
 
   Unit round(unsigned decimal = 1)
   {
-    _count = static_cast<Rep>(std::round(_count * decimal)) / static_cast<Rep>(decimal);
+    _count = static_cast<Rep>(std::round(_count * static_cast<Rep>(decimal))) / static_cast<Rep>(decimal);
+    return *this;
   }
 
 
   Unit trunc(unsigned decimal = 1)
   {
-    _count = static_cast<Rep>(std::trunc(_count * decimal)) / static_cast<Rep>(decimal);
+    _count = static_cast<Rep>(std::trunc(_count * static_cast<Rep>(decimal))) / static_cast<Rep>(decimal);
+    return *this;
   }
 
 
@@ -639,7 +760,12 @@ constexpr auto operator+ (Unit<Dimension1, Rep1, Period1, Origin1> const& Obj1,
 {
   static_assert(std::is_same<Dimension1, Dimension2>::value, "Cannot sum values with different dimension.");
   typedef typename std::common_type<Unit<Dimension1, Rep1, Period1, Origin1>, Unit<Dimension2, Rep2, Period2, Origin2>>::type type;
-  return type(type(Obj1).count() + type(Obj2).count());
+  typedef typename type::rep rep;
+  typedef Conversion<Unit<Dimension1, Rep1, Period1, Origin1>, type> conv1;
+  typedef Conversion<Unit<Dimension2, Rep2, Period2, Origin2>, type> conv2;
+
+  return type(convert_count<rep, rep>(static_cast<rep>(Obj1.count()), conv1::num, conv1::den, conv1::offset)
+    + convert_count<rep, rep>(static_cast<rep>(Obj2.count()), conv2::num, conv2::den, conv2::offset));
 }
 
 
@@ -649,7 +775,12 @@ constexpr auto operator- (Unit<Dimension1, Rep1, Period1, Origin1> const& Obj1,
 {
   static_assert(std::is_same<Dimension1, Dimension2>::value, "Cannot subtract values with different dimension.");
   typedef typename std::common_type<Unit<Dimension1, Rep1, Period1, Origin1>, Unit<Dimension2, Rep2, Period2, Origin2>>::type type;
-  return type(type(Obj1).count() - type(Obj2).count());
+  typedef typename type::rep rep;
+  typedef Conversion<Unit<Dimension1, Rep1, Period1, Origin1>, type> conv1;
+  typedef Conversion<Unit<Dimension2, Rep2, Period2, Origin2>, type> conv2;
+
+  return type(convert_count<rep, rep>(static_cast<rep>(Obj1.count()), conv1::num, conv1::den, conv1::offset)
+    - convert_count<rep, rep>(static_cast<rep>(Obj2.count()), conv2::num, conv2::den, conv2::offset));
 }
 
 
@@ -791,7 +922,18 @@ Unit<Dimension2, Rep2, Period2, Origin2> const& Obj2)
 
   typedef typename std::common_type<Unit<Dimension1, Rep1, Period1, Origin1>,
   Unit<Dimension2, Rep2, Period2, Origin2>>::type type;
-  return std::abs(type(Obj1).count() - type(Obj2).count()) <= Epsilon<typename type::rep>::value;
+  typedef typename type::rep rep;
+  typedef Conversion<Unit<Dimension1, Rep1, Period1, Origin1>, type> conv1;
+  typedef Conversion<Unit<Dimension2, Rep2, Period2, Origin2>, type> conv2;
+
+  rep count1 = convert_count<rep, rep>(static_cast<rep>(Obj1.count()), conv1::num, conv1::den, conv1::offset);
+  rep count2 = convert_count<rep, rep>(static_cast<rep>(Obj2.count()), conv2::num, conv2::den, conv2::offset);
+
+  //integers are compared exactly, without a subtraction which could overflow
+  if constexpr(std::is_floating_point<rep>::value)
+    return math::abs(count1 - count2) <= Epsilon<rep>::value;
+  else
+    return count1 == count2;
 }
 
 
@@ -817,7 +959,17 @@ Unit<Dimension2, Rep2, Period2, Origin2> const& Obj2)
 
   typedef typename std::common_type<Unit<Dimension1, Rep1, Period1, Origin1>,
   Unit<Dimension2, Rep2, Period2, Origin2>>::type type;
-  return (type(Obj1).count() - type(Obj2).count()) < -Epsilon<typename type::rep>::value;
+  typedef typename type::rep rep;
+  typedef Conversion<Unit<Dimension1, Rep1, Period1, Origin1>, type> conv1;
+  typedef Conversion<Unit<Dimension2, Rep2, Period2, Origin2>, type> conv2;
+
+  rep count1 = convert_count<rep, rep>(static_cast<rep>(Obj1.count()), conv1::num, conv1::den, conv1::offset);
+  rep count2 = convert_count<rep, rep>(static_cast<rep>(Obj2.count()), conv2::num, conv2::den, conv2::offset);
+
+  if constexpr(std::is_floating_point<rep>::value)
+    return (count1 - count2) < -Epsilon<rep>::value;
+  else
+    return count1 < count2;
 }
 
 
@@ -948,7 +1100,7 @@ constexpr auto pow(Unit<_Dimension, Rep, Period, Origin> Obj)
   }
 
   typedef Unit<typename Dimension_power<_Dimension, exponent>::type, Rep, typename Ratio_power<Period, exponent>::type, origin_power<Origin, exponent>::value> type;
-  return type(std::pow(Obj.count(), exponent));
+  return type(math::pow(Obj.count(), exponent));
 }
 
 
@@ -962,7 +1114,7 @@ constexpr auto nroot(Unit<_Dimension, Rep, Period, Origin> Obj)
   }
 
   typedef Unit<typename Dimension_root<_Dimension, basis>::type, Rep, typename Ratio_root<Period, basis>::type, origin_root<Origin, basis>::value> type;
-  return type(std::pow(Obj.count(), 1./basis));
+  return type(math::nroot(Obj.count(), basis));
 }
 
 
@@ -1465,13 +1617,13 @@ private:
 
   //the common period is the nearest of 1/1 in order of magnitude
   //should it be the average in log scale ? or the greater one ?
-  typedef typename std::conditional< (std::abs(std::log10(Period1::value)) < std::abs(std::log10(Period2::value))),
+  typedef typename std::conditional< (omni::math::abs(omni::math::log10(Period1::num) - omni::math::log10(Period1::den)) < omni::math::abs(omni::math::log10(Period2::num) - omni::math::log10(Period2::den))),
   Period1, Period2>::type new_Ratio;
 
   typedef typename std::common_type<Rep1, Rep2>::type common;
 
   //if origins are differents, then the common origin is 0...
-  static constexpr double origin = (std::abs(Origin1 - Origin2) <= omni::InternEpsilon<double>::value) ? Origin1 : omni::zero;
+  static constexpr double origin = (omni::math::abs(Origin1 - Origin2) <= omni::InternEpsilon<double>::value) ? Origin1 : omni::zero;
 
 public:
   typedef omni::Unit<Dimension1, common, new_Ratio, origin> type;
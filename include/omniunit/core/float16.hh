@@ -0,0 +1,530 @@
+//float16.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_FLOAT16_HH_
+#define OMNIUNIT_FLOAT16_HH_
+
+// 16 bits floating points, to be used as the Rep of units stored in large arrays :
+// omni::half (IEEE 754 binary16, 3 significant digits up to 65504) and omni::bfloat16
+// (the range of float with 2 to 3 significant digits). They only store : every
+// operation is computed in float (their common type with themselves is float), and
+// the result is rounded to nearest even when it is stored back.
+//
+// omni::widen and omni::narrow convert whole arrays, with F16C when it is enabled
+// (-mf16c, or -march=... on a CPU which has it) ; batch.hh does the same for arrays of units.
+
+#include "math.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+#ifdef __F16C__
+  #include <immintrin.h>
+#endif
+
+
+
+namespace omni
+{
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== ENCODING ================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+enum class Float16Format {Binary16, BFloat16};
+
+
+namespace float16_detail
+{
+
+
+//1 sign bit, then exponent and mantissa bits
+template <Float16Format format>
+struct layout
+{
+  static constexpr int exponent = (format == Float16Format::Binary16 ? 5 : 8);
+  static constexpr int mantissa = (format == Float16Format::Binary16 ? 10 : 7);
+  static constexpr int bias = (1 << (exponent - 1)) - 1;
+  static constexpr std::uint16_t infinity = static_cast<std::uint16_t>(((1 << exponent) - 1) << mantissa);
+};
+
+
+//constant expressions cannot read the bits of a float : the value is rebuilt
+//with exact operations on powers of two, rounded to nearest even
+template <Float16Format format>
+constexpr std::uint16_t encode(float value)
+{
+  typedef layout<format> l;
+
+  if(math::detail::is_nan(value))
+    return static_cast<std::uint16_t>(l::infinity | (1 << (l::mantissa - 1)));
+
+  std::uint16_t sign = (value < 0 ? 0x8000 : 0);
+  double x = math::abs(static_cast<double>(value));
+  if(x > static_cast<double>(std::numeric_limits<float>::max()))
+    return static_cast<std::uint16_t>(sign | l::infinity);
+
+  //exponent of x, which is the minimum one for subnormals
+  int exponent = 1 - l::bias;
+  while(exponent <= l::bias && x >= math::pow(2., exponent + 1))
+    ++exponent;
+  if(exponent > l::bias)
+    return static_cast<std::uint16_t>(sign | l::infinity);
+
+  //significand in units of the last place (exact), then rounded
+  double scaled = x / math::pow(2., exponent - l::mantissa);
+  double rounded = math::floor(scaled);
+  double rest = scaled - rounded;
+  if(rest > 0.5 || (rest >= 0.5 && (static_cast<std::uint32_t>(rounded) & 1) == 1))
+    rounded += 1;
+
+  std::uint32_t significand = static_cast<std::uint32_t>(rounded);
+  std::uint32_t biased = (significand >> l::mantissa) == 0 ? 0 : static_cast<std::uint32_t>(exponent + l::bias);
+  if(significand >> (l::mantissa + 1) != 0) //rounded up to the next power of two
+  {
+    ++biased;
+    significand >>= 1;
+  }
+  if(biased >= (1u << l::exponent) - 1)
+    return static_cast<std::uint16_t>(sign | l::infinity);
+  return static_cast<std::uint16_t>(sign | (biased << l::mantissa) | (significand & ((1u << l::mantissa) - 1)));
+}
+
+
+template <Float16Format format>
+constexpr float decode(std::uint16_t bits)
+{
+  typedef layout<format> l;
+
+  bool negative = (bits & 0x8000) != 0;
+  int biased = (bits >> l::mantissa) & ((1 << l::exponent) - 1);
+  double significand = static_cast<double>(bits & ((1 << l::mantissa) - 1));
+
+  if(biased == (1 << l::exponent) - 1)
+  {
+    if(significand > 0)
+      return std::numeric_limits<float>::quiet_NaN();
+    return negative ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+  }
+
+  double value = (biased == 0 ? significand * math::pow(2., 1 - l::bias - l::mantissa)
+                              : (significand + math::pow(2., l::mantissa)) * math::pow(2., biased - l::bias - l::mantissa));
+  return static_cast<float>(negative ? -value : value);
+}
+
+
+inline std::uint32_t float_bits(float value)
+{
+  std::uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(float));
+  return bits;
+}
+
+
+inline float bits_float(std::uint32_t bits)
+{
+  float value = 0;
+  std::memcpy(&value, &bits, sizeof(float));
+  return value;
+}
+
+
+//at runtime, conversions work on the bits (round to nearest even as well) :
+//binary16 as in F. Giesen's float_to_half_fast3_rtne and half_to_float, bfloat16 is
+//the upper half of a float
+inline std::uint16_t encode_binary16(float value)
+{
+#ifdef __F16C__
+  return static_cast<std::uint16_t>(_cvtss_sh(value, 0));
+#else
+  std::uint32_t bits = float_bits(value);
+  std::uint32_t sign = bits & 0x80000000u;
+  bits ^= sign;
+
+  std::uint32_t result = 0;
+  if(bits >= (127u + 16u) << 23) //not below 65536 : infinity, or NaN
+    result = (bits > 0x7F800000u ? 0x7E00u : 0x7C00u);
+  else if(bits < 113u << 23) //subnormal (or zero) : aligned by a float addition
+    result = float_bits(bits_float(bits) + bits_float(126u << 23)) - (126u << 23);
+  else
+  {
+    std::uint32_t odd = (bits >> 13) & 1u;
+    bits += (static_cast<std::uint32_t>(15 - 127) << 23) + 0xFFFu + odd;
+    result = bits >> 13;
+  }
+  return static_cast<std::uint16_t>(result | (sign >> 16));
+#endif
+}
+
+
+inline float decode_binary16(std::uint16_t half)
+{
+#ifdef __F16C__
+  return _cvtsh_ss(half);
+#else
+  std::uint32_t bits = static_cast<std::uint32_t>(half & 0x7FFFu) << 13;
+  std::uint32_t exponent = bits & (0x7C00u << 13);
+  bits += (127u - 15u) << 23;
+  float value = 0;
+  if(exponent == 0x7C00u << 13) //infinity or NaN
+    value = bits_float(bits + ((128u - 16u) << 23));
+  else if(exponent == 0) //subnormal (or zero) : normalized by a float subtraction
+    value = bits_float(bits + (1u << 23)) - bits_float(113u << 23);
+  else
+    value = bits_float(bits);
+  return bits_float(float_bits(value) | (static_cast<std::uint32_t>(half & 0x8000u) << 16));
+#endif
+}
+
+
+inline std::uint16_t encode_bfloat16(float value)
+{
+  std::uint32_t bits = float_bits(value);
+  if((bits & 0x7FFFFFFFu) > 0x7F800000u) //NaN stays a (quiet) NaN
+    return static_cast<std::uint16_t>((bits >> 16) | 0x40u);
+  return static_cast<std::uint16_t>((bits + 0x7FFFu + ((bits >> 16) & 1u)) >> 16);
+}
+
+
+inline float decode_bfloat16(std::uint16_t bfloat)
+{
+  return bits_float(static_cast<std::uint32_t>(bfloat) << 16);
+}
+
+
+} //namespace float16_detail
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== FLOAT16 =================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <Float16Format format>
+class Float16
+{
+public:
+  constexpr Float16():
+  _bits(0)
+  {
+  }
+
+
+  //implicit, like a conversion between floating points
+  template <typename U, typename = typename std::enable_if<std::is_arithmetic<U>::value, U>::type>
+  constexpr Float16(U value):
+  _bits(encode(static_cast<float>(value)))
+  {
+  }
+
+
+  constexpr operator float() const
+  {
+    if(OMNI_CONSTANT_EVALUATED())
+      return float16_detail::decode<format>(_bits);
+    if constexpr(format == Float16Format::Binary16)
+      return float16_detail::decode_binary16(_bits);
+    else
+      return float16_detail::decode_bfloat16(_bits);
+  }
+
+
+  static constexpr Float16 from_bits(std::uint16_t bits)
+  {
+    Float16 value;
+    value._bits = bits;
+    return value;
+  }
+
+
+  constexpr std::uint16_t bits() const
+  {
+    return _bits;
+  }
+
+
+  template <typename U>
+  constexpr Float16& operator+=(U const& other)
+  {
+    return *this = static_cast<float>(*this) + other;
+  }
+
+
+  template <typename U>
+  constexpr Float16& operator-=(U const& other)
+  {
+    return *this = static_cast<float>(*this) - other;
+  }
+
+
+  template <typename U>
+  constexpr Float16& operator*=(U const& other)
+  {
+    return *this = static_cast<float>(*this) * other;
+  }
+
+
+  template <typename U>
+  constexpr Float16& operator/=(U const& other)
+  {
+    return *this = static_cast<float>(*this) / other;
+  }
+
+
+  constexpr Float16& operator++()
+  {
+    return *this += 1.f;
+  }
+
+
+  constexpr Float16 operator++(int)
+  {
+    Float16 old(*this);
+    *this += 1.f;
+    return old;
+  }
+
+
+  constexpr Float16& operator--()
+  {
+    return *this -= 1.f;
+  }
+
+
+  constexpr Float16 operator--(int)
+  {
+    Float16 old(*this);
+    *this -= 1.f;
+    return old;
+  }
+
+
+private:
+  static constexpr std::uint16_t encode(float value)
+  {
+    if(OMNI_CONSTANT_EVALUATED())
+      return float16_detail::encode<format>(value);
+    if constexpr(format == Float16Format::Binary16)
+      return float16_detail::encode_binary16(value);
+    else
+      return float16_detail::encode_bfloat16(value);
+  }
+
+  std::uint16_t _bits;
+};
+
+
+typedef Float16<Float16Format::Binary16> half;
+typedef Float16<Float16Format::BFloat16> bfloat16;
+
+
+template <Float16Format format>
+std::ostream& operator<<(std::ostream& stream, Float16<format> const& x)
+{
+  return stream << static_cast<float>(x);
+}
+
+
+template<typename falseType>
+struct is_Float16 : std::false_type
+{
+};
+
+
+template<Float16Format format>
+struct is_Float16<Float16<format>> : public std::true_type
+{
+};
+
+
+
+namespace math
+{
+
+
+//omni::pow, omni::sqrt... of units stored with 16 bits are computed in float, as by widen(),
+//and rounded back to 16 bits by the Unit they build
+template<Float16Format format>
+struct computation<Float16<format>>
+{
+  typedef float type;
+
+  static constexpr float value(Float16<format> const& x)
+  {
+    return static_cast<float>(x);
+  }
+};
+
+
+} //namespace math
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== BULK CONVERSIONS ========================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//size values stored with 16 bits to floats
+template <Float16Format format>
+void widen(Float16<format> const* in, std::size_t size, float* out)
+{
+  std::size_t i = 0;
+#ifdef __F16C__
+  if constexpr(format == Float16Format::Binary16)
+  {
+    for(; i + 8 <= size; i += 8)
+      _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i))));
+  }
+#endif
+  for(; i < size; i++)
+    out[i] = static_cast<float>(in[i]);
+}
+
+
+//size floats to values stored with 16 bits, rounded to nearest even
+template <Float16Format format>
+void narrow(float const* in, std::size_t size, Float16<format>* out)
+{
+  std::size_t i = 0;
+#ifdef __F16C__
+  if constexpr(format == Float16Format::Binary16)
+  {
+    for(; i + 8 <= size; i += 8)
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), 0));
+  }
+#endif
+  for(; i < size; i++)
+    out[i] = in[i];
+}
+
+
+
+} //namespace omni
+
+
+
+namespace std
+{
+
+
+
+template<omni::Float16Format format>
+struct numeric_limits<omni::Float16<format>>
+{
+private:
+  typedef omni::float16_detail::layout<format> l;
+  typedef omni::Float16<format> type;
+
+public:
+  static constexpr bool is_specialized = true;
+  static constexpr bool is_signed = true;
+  static constexpr bool is_integer = false;
+  static constexpr bool is_exact = false;
+  static constexpr bool has_infinity = true;
+  static constexpr bool has_quiet_NaN = true;
+  static constexpr bool has_signaling_NaN = false;
+  static constexpr float_round_style round_style = round_to_nearest;
+  static constexpr bool is_iec559 = (format == omni::Float16Format::Binary16);
+  static constexpr bool is_bounded = true;
+  static constexpr bool is_modulo = false;
+  static constexpr int radix = 2;
+  static constexpr int digits = l::mantissa + 1;
+  static constexpr int digits10 = (format == omni::Float16Format::Binary16 ? 3 : 2);
+  static constexpr int max_digits10 = (format == omni::Float16Format::Binary16 ? 5 : 4);
+  static constexpr int min_exponent = 2 - l::bias;
+  static constexpr int max_exponent = l::bias + 1;
+
+  static constexpr type min() noexcept {return type::from_bits(static_cast<std::uint16_t>(1 << l::mantissa));}
+  static constexpr type max() noexcept {return type::from_bits(static_cast<std::uint16_t>(l::infinity - 1));}
+  static constexpr type lowest() noexcept {return type::from_bits(static_cast<std::uint16_t>(0x8000 | (l::infinity - 1)));}
+  static constexpr type epsilon() noexcept {return type::from_bits(static_cast<std::uint16_t>((l::bias - l::mantissa) << l::mantissa));}
+  static constexpr type round_error() noexcept {return type::from_bits(static_cast<std::uint16_t>((l::bias - 1) << l::mantissa));}
+  static constexpr type infinity() noexcept {return type::from_bits(l::infinity);}
+  static constexpr type quiet_NaN() noexcept {return type::from_bits(static_cast<std::uint16_t>(l::infinity | (1 << (l::mantissa - 1))));}
+  static constexpr type denorm_min() noexcept {return type::from_bits(1);}
+};
+
+
+//operations on 16 bits floating points are computed in float
+template<omni::Float16Format format1, omni::Float16Format format2>
+struct common_type<omni::Float16<format1>, omni::Float16<format2>>
+{
+  typedef float type;
+};
+
+
+template<omni::Float16Format format, typename U>
+struct common_type<omni::Float16<format>, U>
+{
+  typedef typename common_type<float, U>::type type;
+};
+
+
+template<typename U, omni::Float16Format format>
+struct common_type<U, omni::Float16<format>>
+{
+  typedef typename common_type<float, U>::type type;
+};
+
+
+
+} //namespace std
+
+
+
+#endif //OMNIUNIT_FLOAT16_HH_
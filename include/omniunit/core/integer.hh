@@ -0,0 +1,653 @@
+//integer.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_INTEGER_HH_
+#define OMNIUNIT_INTEGER_HH_
+
+// integer representations with an overflow policy, to be used as the Rep of a Unit :
+// omni::meter<omni::checked<std::int64_t>> throws std::overflow_error when an
+// operation or a conversion does not fit, saturating<> stops at the limits of the
+// type and wrapping<> wraps around (modulo 2^N). Division and modulo by zero throw
+// std::domain_error whatever the policy.
+//
+// the same policies apply to conversions between plain integer representations :
+// Trap if OMNI_CHECK_INTEGER_OVERFLOW is true, Wrap (the default) otherwise.
+
+#include "../settings.hh"
+#include "utility.hh"
+
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+//GCC and Clang detect overflows with the carry flag
+#if defined(__has_builtin)
+  #if __has_builtin(__builtin_add_overflow) && __has_builtin(__builtin_sub_overflow) && __has_builtin(__builtin_mul_overflow)
+    #define OMNI_OVERFLOW_BUILTINS
+  #endif
+#elif defined(__GNUC__)
+  #define OMNI_OVERFLOW_BUILTINS
+#endif
+
+
+
+namespace omni
+{
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== OVERFLOW DETECTION ======================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//what integer arithmetic does when a result does not fit its type
+enum class Overflow {Trap, Saturate, Wrap};
+
+
+template <typename T>
+constexpr bool is_negative(T x)
+{
+  if constexpr(std::is_signed<T>::value)
+    return x < 0;
+  else
+  {
+    static_cast<void>(x);
+    return false;
+  }
+}
+
+
+//these functions give the wrapped result and return true if it overflowed
+template <typename T>
+constexpr bool add_overflow(T a, T b, T& result)
+{
+#ifdef OMNI_OVERFLOW_BUILTINS
+  return __builtin_add_overflow(a, b, &result);
+#else
+  result = static_cast<T>(static_cast<std::uintmax_t>(a) + static_cast<std::uintmax_t>(b));
+  if constexpr(std::is_signed<T>::value)
+    return is_negative(a) == is_negative(b) && is_negative(result) != is_negative(a);
+  else
+    return result < a;
+#endif
+}
+
+
+template <typename T>
+constexpr bool subtract_overflow(T a, T b, T& result)
+{
+#ifdef OMNI_OVERFLOW_BUILTINS
+  return __builtin_sub_overflow(a, b, &result);
+#else
+  result = static_cast<T>(static_cast<std::uintmax_t>(a) - static_cast<std::uintmax_t>(b));
+  if constexpr(std::is_signed<T>::value)
+    return is_negative(a) != is_negative(b) && is_negative(result) != is_negative(a);
+  else
+    return a < b;
+#endif
+}
+
+
+template <typename T>
+constexpr bool multiply_overflow(T a, T b, T& result)
+{
+#ifdef OMNI_OVERFLOW_BUILTINS
+  return __builtin_mul_overflow(a, b, &result);
+#else
+  result = static_cast<T>(static_cast<std::uintmax_t>(a) * static_cast<std::uintmax_t>(b));
+  if constexpr(std::is_signed<T>::value)
+  {
+    if(a == -1)
+      return b == std::numeric_limits<T>::min();
+  }
+  return a != 0 && result / a != b;
+#endif
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== OVERFLOW POLICIES =======================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//result of an operation which overflowed : upward tells if the exact result
+//is above the maximum (true) or under the minimum (false)
+template <Overflow policy, typename T>
+constexpr T overflowed(T wrapped, bool upward)
+{
+  if(policy == Overflow::Trap)
+    throw std::overflow_error("omni : integer overflow.");
+  if(policy == Overflow::Saturate)
+    return upward ? std::numeric_limits<T>::max() : std::numeric_limits<T>::min();
+  return wrapped;
+}
+
+
+template <Overflow policy, typename T>
+constexpr T integer_add(T a, T b)
+{
+  T result = 0;
+  bool overflow = add_overflow(a, b, result);
+  return overflow ? overflowed<policy>(result, !is_negative(b)) : result;
+}
+
+
+template <Overflow policy, typename T>
+constexpr T integer_subtract(T a, T b)
+{
+  T result = 0;
+  bool overflow = subtract_overflow(a, b, result);
+  return overflow ? overflowed<policy>(result, is_negative(b)) : result;
+}
+
+
+template <Overflow policy, typename T>
+constexpr T integer_multiply(T a, T b)
+{
+  T result = 0;
+  bool overflow = multiply_overflow(a, b, result);
+  return overflow ? overflowed<policy>(result, is_negative(a) == is_negative(b)) : result;
+}
+
+
+//truncated, like built-in integer division
+template <Overflow policy, typename T>
+constexpr T integer_divide(T a, T b)
+{
+  if(b == 0)
+    throw std::domain_error("omni : integer division by zero.");
+  if constexpr(std::is_signed<T>::value)
+  {
+    if(b == -1)
+      return integer_subtract<policy>(T(0), a);
+  }
+  return static_cast<T>(a / b);
+}
+
+
+template <Overflow policy, typename T>
+constexpr T integer_modulo(T a, T b)
+{
+  if(b == 0)
+    throw std::domain_error("omni : integer modulo by zero.");
+  if constexpr(std::is_signed<T>::value)
+  {
+    if(b == -1)
+      return 0;
+  }
+  return static_cast<T>(a % b);
+}
+
+
+//conversion of an arithmetic value to the integer type T.
+//A floating point is truncated ; out of range, it cannot wrap and saturates with Wrap as well.
+template <typename T, Overflow policy, typename U>
+constexpr T integer_cast(U value)
+{
+  static_assert(std::is_integral<T>::value && std::is_arithmetic<U>::value, "Arguments should be an integer type and an arithmetic value.");
+
+  if constexpr(std::is_floating_point<U>::value)
+  {
+    if(!(value <= value)) //NaN : 0 if it does not trap
+    {
+      if(policy == Overflow::Trap)
+        throw std::overflow_error("omni : NaN converted to an integer.");
+      return 0;
+    }
+    U truncated = math::trunc(value);
+    if(truncated < static_cast<U>(std::numeric_limits<T>::min()))
+      return overflowed<policy>(std::numeric_limits<T>::min(), false);
+    if(truncated >= static_cast<U>(std::numeric_limits<T>::max()) + 1)
+      return overflowed<policy>(std::numeric_limits<T>::max(), true);
+    return static_cast<T>(truncated);
+  }
+  else if constexpr(std::numeric_limits<T>::min() <= std::numeric_limits<U>::min() && std::numeric_limits<T>::max() >= std::numeric_limits<U>::max())
+    return static_cast<T>(value); //every value of U fits
+  else
+  {
+    //compare in the widest type able to hold both signs
+    bool below = is_negative(value) && (std::is_unsigned<T>::value || static_cast<std::intmax_t>(value) < static_cast<std::intmax_t>(std::numeric_limits<T>::min()));
+    bool above = !is_negative(value) && static_cast<std::uintmax_t>(value) > static_cast<std::uintmax_t>(std::numeric_limits<T>::max());
+    return (below || above) ? overflowed<policy>(static_cast<T>(value), above) : static_cast<T>(value);
+  }
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== INTEGER =================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <typename T, Overflow policy>
+class Integer
+{
+public:
+  typedef T value_type;
+  static constexpr Overflow overflow = policy;
+
+  static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "First template argument should be an integer type.");
+
+  constexpr Integer():
+  _value(0)
+  {
+  }
+
+
+  template <typename U, typename = typename std::enable_if<std::is_arithmetic<U>::value, U>::type>
+  constexpr explicit Integer(U value):
+  _value(integer_cast<T, policy>(value))
+  {
+  }
+
+
+  //policies do not mix : the value of an Integer with another policy must be taken with value()
+  template <typename U>
+  constexpr explicit Integer(Integer<U, policy> const& other):
+  _value(integer_cast<T, policy>(other.value()))
+  {
+  }
+
+
+  constexpr T value() const
+  {
+    return _value;
+  }
+
+
+  template <typename U, typename = typename std::enable_if<std::is_arithmetic<U>::value, U>::type>
+  constexpr explicit operator U() const
+  {
+    return static_cast<U>(_value);
+  }
+
+
+  constexpr Integer& operator+=(Integer const& other)
+  {
+    _value = integer_add<policy>(_value, other._value);
+    return *this;
+  }
+
+
+  constexpr Integer& operator-=(Integer const& other)
+  {
+    _value = integer_subtract<policy>(_value, other._value);
+    return *this;
+  }
+
+
+  constexpr Integer& operator*=(Integer const& other)
+  {
+    _value = integer_multiply<policy>(_value, other._value);
+    return *this;
+  }
+
+
+  constexpr Integer& operator/=(Integer const& other)
+  {
+    _value = integer_divide<policy>(_value, other._value);
+    return *this;
+  }
+
+
+  constexpr Integer& operator%=(Integer const& other)
+  {
+    _value = integer_modulo<policy>(_value, other._value);
+    return *this;
+  }
+
+
+  constexpr Integer& operator++()
+  {
+    return *this += Integer(1);
+  }
+
+
+  constexpr Integer operator++(int)
+  {
+    Integer old(*this);
+    *this += Integer(1);
+    return old;
+  }
+
+
+  constexpr Integer& operator--()
+  {
+    return *this -= Integer(1);
+  }
+
+
+  constexpr Integer operator--(int)
+  {
+    Integer old(*this);
+    *this -= Integer(1);
+    return old;
+  }
+
+
+private:
+  T _value;
+};
+
+
+template <typename T = std::int64_t>
+using checked = Integer<T, Overflow::Trap>;
+
+template <typename T = std::int64_t>
+using saturating = Integer<T, Overflow::Saturate>;
+
+template <typename T = std::int64_t>
+using wrapping = Integer<T, Overflow::Wrap>;
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== INTEGER OPERATORS =======================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//like built-in integers, an Integer and a floating point give a floating point.
+//An integer operand is converted to the Integer type first (with its policy).
+#define OMNI_INTEGER_OPERATOR(op) \
+template <typename T, Overflow policy> \
+constexpr Integer<T, policy> operator op(Integer<T, policy> left, Integer<T, policy> const& right) \
+{ \
+  return left op##= right; \
+} \
+\
+template <typename T, Overflow policy, typename U, typename = typename std::enable_if<std::is_arithmetic<U>::value, U>::type> \
+constexpr auto operator op(Integer<T, policy> left, U const& right) \
+{ \
+  if constexpr(std::is_floating_point<U>::value) \
+    return static_cast<U>(left.value()) op right; \
+  else \
+    return left op##= Integer<T, policy>(right); \
+} \
+\
+template <typename T, Overflow policy, typename U, typename = typename std::enable_if<std::is_arithmetic<U>::value, U>::type> \
+constexpr auto operator op(U const& left, Integer<T, policy> const& right) \
+{ \
+  if constexpr(std::is_floating_point<U>::value) \
+    return left op static_cast<U>(right.value()); \
+  else \
+    return Integer<T, policy>(left) op##= right; \
+}
+
+OMNI_INTEGER_OPERATOR(+)
+OMNI_INTEGER_OPERATOR(-)
+OMNI_INTEGER_OPERATOR(*)
+OMNI_INTEGER_OPERATOR(/)
+OMNI_INTEGER_OPERATOR(%)
+
+#undef OMNI_INTEGER_OPERATOR
+
+
+template <typename T, Overflow policy>
+constexpr Integer<T, policy> operator+(Integer<T, policy> const& x)
+{
+  return x;
+}
+
+
+template <typename T, Overflow policy>
+constexpr Integer<T, policy> operator-(Integer<T, policy> const& x)
+{
+  return Integer<T, policy>() -= x;
+}
+
+
+template <typename T, Overflow policy>
+constexpr bool operator==(Integer<T, policy> const& left, Integer<T, policy> const& right)
+{
+  return left.value() == right.value();
+}
+
+
+template <typename T, Overflow policy>
+constexpr bool operator!=(Integer<T, policy> const& left, Integer<T, policy> const& right)
+{
+  return left.value() != right.value();
+}
+
+
+template <typename T, Overflow policy>
+constexpr bool operator<(Integer<T, policy> const& left, Integer<T, policy> const& right)
+{
+  return left.value() < right.value();
+}
+
+
+template <typename T, Overflow policy>
+constexpr bool operator<=(Integer<T, policy> const& left, Integer<T, policy> const& right)
+{
+  return left.value() <= right.value();
+}
+
+
+template <typename T, Overflow policy>
+constexpr bool operator>(Integer<T, policy> const& left, Integer<T, policy> const& right)
+{
+  return left.value() > right.value();
+}
+
+
+template <typename T, Overflow policy>
+constexpr bool operator>=(Integer<T, policy> const& left, Integer<T, policy> const& right)
+{
+  return left.value() >= right.value();
+}
+
+
+template <typename T, Overflow policy>
+std::ostream& operator<<(std::ostream& stream, Integer<T, policy> const& x)
+{
+  return stream << +x.value(); //+ prints 8 bits integers as numbers
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== INTEGER TRAITS ==========================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template<typename falseType>
+struct is_Integer : std::false_type
+{
+};
+
+
+template<typename T, Overflow policy>
+struct is_Integer<Integer<T, policy>> : public std::true_type
+{
+};
+
+
+//type of the uncertainty of a unit whose Rep is T, when OMNI_USE_SAME_TYPE_FOR_UNCERTAINTIES
+//is true : an uncertainty has no overflow policy
+template<typename T>
+struct uncertainty_rep
+{
+  typedef T type;
+};
+
+
+template<typename T, Overflow policy>
+struct uncertainty_rep<Integer<T, policy>>
+{
+  typedef T type;
+};
+
+
+//types converted with integer arithmetic (see convert_count)
+template<typename T>
+struct is_integer_rep : public std::integral_constant<bool, std::is_integral<T>::value || is_Integer<T>::value>
+{
+};
+
+
+//underlying integer and overflow policy of an integer Rep
+template<typename T>
+struct integer_traits
+{
+  typedef T type;
+  static constexpr Overflow overflow = (OMNI_CHECK_INTEGER_OVERFLOW ? Overflow::Trap : Overflow::Wrap);
+
+  static constexpr T value(T x)
+  {
+    return x;
+  }
+};
+
+
+template<typename T, Overflow policy>
+struct integer_traits<Integer<T, policy>>
+{
+  typedef T type;
+  static constexpr Overflow overflow = policy;
+
+  static constexpr T value(Integer<T, policy> const& x)
+  {
+    return x.value();
+  }
+};
+
+
+
+namespace math
+{
+
+
+//omni::pow, omni::sqrt... of units with an Integer Rep are computed from the value, like plain integers
+template<typename T, Overflow policy>
+struct computation<Integer<T, policy>>
+{
+  typedef T type;
+
+  static constexpr T value(Integer<T, policy> const& x)
+  {
+    return x.value();
+  }
+};
+
+
+} //namespace math
+
+
+
+} //namespace omni
+
+
+
+namespace std
+{
+
+
+
+template<typename T, omni::Overflow policy>
+struct numeric_limits<omni::Integer<T, policy>> : public numeric_limits<T>
+{
+  static constexpr bool is_modulo = (policy == omni::Overflow::Wrap);
+
+  static constexpr omni::Integer<T, policy> min() noexcept {return omni::Integer<T, policy>(numeric_limits<T>::min());}
+  static constexpr omni::Integer<T, policy> max() noexcept {return omni::Integer<T, policy>(numeric_limits<T>::max());}
+  static constexpr omni::Integer<T, policy> lowest() noexcept {return omni::Integer<T, policy>(numeric_limits<T>::lowest());}
+  static constexpr omni::Integer<T, policy> epsilon() noexcept {return omni::Integer<T, policy>();}
+  static constexpr omni::Integer<T, policy> round_error() noexcept {return omni::Integer<T, policy>();}
+  static constexpr omni::Integer<T, policy> infinity() noexcept {return omni::Integer<T, policy>();}
+  static constexpr omni::Integer<T, policy> quiet_NaN() noexcept {return omni::Integer<T, policy>();}
+  static constexpr omni::Integer<T, policy> signaling_NaN() noexcept {return omni::Integer<T, policy>();}
+  static constexpr omni::Integer<T, policy> denorm_min() noexcept {return omni::Integer<T, policy>();}
+};
+
+
+template<typename T1, omni::Overflow policy1, typename T2, omni::Overflow policy2>
+struct common_type<omni::Integer<T1, policy1>, omni::Integer<T2, policy2>>
+{
+  static_assert(policy1 == policy2, "Integers with different overflow policies do not mix.");
+  typedef omni::Integer<typename common_type<T1, T2>::type, policy1> type;
+};
+
+
+//with a floating point, the common type is the floating point
+template<typename T, omni::Overflow policy, typename U>
+struct common_type<omni::Integer<T, policy>, U>
+{
+  static_assert(std::is_arithmetic<U>::value, "An Integer has only a common type with arithmetics.");
+  typedef typename conditional<is_floating_point<U>::value, U, omni::Integer<typename common_type<T, U>::type, policy>>::type type;
+};
+
+
+template<typename U, typename T, omni::Overflow policy>
+struct common_type<U, omni::Integer<T, policy>>
+{
+  typedef typename common_type<omni::Integer<T, policy>, U>::type type;
+};
+
+
+
+} //namespace std
+
+
+
+#endif //OMNIUNIT_INTEGER_HH_
@@ -0,0 +1,107 @@
+//kernels.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_KERNELS_HH_
+#define OMNIUNIT_KERNELS_HH_
+
+// loop kernels shared by the headers working on arrays of units (calculus.hh,
+// reduce.hh, parallel.hh, sharded.hh, queue.hh) :
+//
+//   accumulator_t   floating type in which counts are summed
+//   lane_sum        sum over 8 independent lanes, which vectorizes
+//   tree            any associative op along a pairwise tree
+//   cacheLine       alignment keeping data written by different threads apart
+
+#include <cstddef>
+#include <type_traits>
+
+
+
+namespace omni
+{
+namespace kernel_detail
+{
+
+
+//counts are added in double, or in long double for long double Reps
+template <typename Rep>
+using accumulator_t = typename std::conditional<std::is_same<Rep, long double>::value, long double, double>::type;
+
+
+//independent partial results : the additions of one lane do not wait for the others
+inline constexpr std::size_t lanes = 8;
+
+//pairwise summations and reductions stop halving at this size
+inline constexpr std::size_t pairwiseBlock = 64;
+
+//alignment of data written by different threads : a cache line on most processors
+inline constexpr std::size_t cacheLine = 64;
+
+
+//sum of term(i) for i in [0, size)
+template <typename acc, typename Term>
+acc lane_sum(std::size_t size, Term const& term)
+{
+  acc partial[lanes] = {};
+  std::size_t i = 0;
+  for(; i + lanes <= size; i += lanes)
+    for(std::size_t l = 0; l < lanes; l++)
+      partial[l] += term(i + l);
+  for(; i < size; i++)
+    partial[0] += term(i);
+
+  acc sum = 0;
+  for(std::size_t l = 0; l < lanes; l++)
+    sum += partial[l];
+  return sum;
+}
+
+
+//op over a pairwise tree of the elements load(i), i in [start, start + size), size > 0
+template <typename T, typename Load, typename BinaryOp>
+T tree(std::size_t start, std::size_t size, Load const& load, BinaryOp const& op)
+{
+  if(size == 1)
+    return T(load(start));
+  std::size_t half = size / 2;
+  return op(tree<T>(start, half, load, op), tree<T>(start + half, size - half, load, op));
+}
+
+
+} //namespace kernel_detail
+} //namespace omni
+
+
+
+#endif //OMNIUNIT_KERNELS_HH_
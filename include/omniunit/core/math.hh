@@ -0,0 +1,449 @@
+//math.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_MATH_HH_
+#define OMNIUNIT_MATH_HH_
+
+// constexpr counterparts of the <cmath> functions the library needs at compile
+// time. std::pow, std::sqrt, std::log10... are not constexpr : they only fold
+// as GCC builtins. When the compiler tells whether it is evaluating a constant
+// expression, runtime calls still go to <cmath> (same results as before, and
+// vectorizable). Otherwise, the constexpr algorithms below are always used.
+// nroot handles signs and special values the same way on both paths (odd roots of
+// negative values are negative), and corrects std::cbrt and std::pow at runtime to the
+// nearest root, so that perfect powers give the same exact roots.
+//
+// accuracy of the compile-time versions :
+//   abs, floor, ceil, round, trunc  exact
+//   pow (integer exponent)          squaring, exact as long as the result is representable
+//   sqrt                            rounded to nearest (Newton, then the nearest of three neighbours)
+//   nroot                           within 1 ulp, exact for perfect powers
+//   log10                           within a few ulp, exact for powers of ten up to 10^22
+
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <type_traits>
+
+#if defined(__cpp_lib_is_constant_evaluated)
+  #define OMNI_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__has_builtin)
+  #if __has_builtin(__builtin_is_constant_evaluated)
+    #define OMNI_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+  #endif
+#elif defined(_MSC_VER)
+  #if _MSC_VER >= 1925
+    #define OMNI_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+  #endif
+#endif
+
+#ifndef OMNI_CONSTANT_EVALUATED
+  #define OMNI_CONSTANT_EVALUATED() true
+#endif
+
+
+
+namespace omni
+{
+namespace math
+{
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== ROUNDING ================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//integers are computed in double, like <cmath> does
+template <typename T>
+using floating_t = typename std::conditional<std::is_integral<T>::value, double, T>::type;
+
+
+//arithmetic value of a representation, for pow, sqrt, nroot and log10 : representations
+//which are not arithmetic types specialize it (see integer.hh)
+template <typename T>
+struct computation
+{
+  typedef T type;
+
+  static constexpr T value(T x)
+  {
+    return x;
+  }
+};
+
+
+template <typename T>
+using computed_t = floating_t<typename computation<T>::type>;
+
+
+namespace detail
+{
+
+
+//exact comparisons, without -Wfloat-equal
+template <typename F>
+constexpr bool same(F a, F b)
+{
+  return a <= b && a >= b;
+}
+
+
+template <typename F>
+constexpr bool is_nan(F x)
+{
+  return !(x <= x);
+}
+
+
+} //namespace detail
+
+
+template <typename T>
+constexpr T abs(T x)
+{
+  static_assert(std::is_arithmetic<T>::value, "Argument should be an arithmetic value.");
+  if constexpr(std::is_unsigned<T>::value)
+    return x;
+  else
+    return x < 0 ? -x : x;
+}
+
+
+template <typename T>
+constexpr floating_t<T> floor(T x)
+{
+  static_assert(std::is_arithmetic<T>::value, "Argument should be an arithmetic value.");
+  typedef floating_t<T> F;
+  F y = static_cast<F>(x);
+  if(!OMNI_CONSTANT_EVALUATED())
+    return std::floor(y);
+
+  F m = abs(y);
+  // above 2^63, every floating point is an integer (and NaN stays NaN)
+  if(!(m < static_cast<F>(9223372036854775808.)))
+    return y;
+  F t = static_cast<F>(static_cast<unsigned long long>(m));
+  if(y >= 0)
+    return t;
+  return t < m ? -t - 1 : -t;
+}
+
+
+template <typename T>
+constexpr floating_t<T> ceil(T x)
+{
+  if(!OMNI_CONSTANT_EVALUATED())
+    return std::ceil(static_cast<floating_t<T>>(x));
+  return -floor(-static_cast<floating_t<T>>(x));
+}
+
+
+template <typename T>
+constexpr floating_t<T> trunc(T x)
+{
+  typedef floating_t<T> F;
+  F y = static_cast<F>(x);
+  if(!OMNI_CONSTANT_EVALUATED())
+    return std::trunc(y);
+  return y < 0 ? -floor(-y) : floor(y);
+}
+
+
+//halfway cases away from zero
+template <typename T>
+constexpr floating_t<T> round(T x)
+{
+  typedef floating_t<T> F;
+  F y = static_cast<F>(x);
+  if(!OMNI_CONSTANT_EVALUATED())
+    return std::round(y);
+  F m = abs(y);
+  F t = floor(m);
+  if(m - t >= static_cast<F>(0.5))
+    t += 1;
+  return y < 0 ? -t : t;
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== POWERS AND ROOTS ========================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <typename T>
+constexpr computed_t<T> pow(T x, int exponent)
+{
+  static_assert(std::is_arithmetic<typename computation<T>::type>::value, "Argument should be an arithmetic value, or a representation computed as one.");
+  typedef computed_t<T> F;
+  F y = static_cast<F>(computation<T>::value(x));
+  if(!OMNI_CONSTANT_EVALUATED())
+    return static_cast<F>(std::pow(y, exponent));
+
+  unsigned n = static_cast<unsigned>(exponent < 0 ? -exponent : exponent);
+  F result = 1;
+  while(n != 0)
+  {
+    if(n % 2 == 1)
+      result *= y;
+    y *= y;
+    n /= 2;
+  }
+  return exponent < 0 ? 1 / result : result;
+}
+
+
+namespace detail
+{
+
+
+//x*x - target without rounding error (Dekker), for x and target close to each other
+template <typename F>
+constexpr F square_residual(F x, F target)
+{
+  constexpr F splitter = static_cast<F>((1ULL << ((std::numeric_limits<F>::digits + 1) / 2)) + 1);
+  F c = splitter * x;
+  F high = c - (c - x);
+  F low = x - high;
+  F p = x * x;
+  F error = ((high * high - p) + 2 * high * low) + low * low;
+  return (p - target) + error;
+}
+
+
+//x in [1, 4) : Newton from above, which decreases until it converges
+template <typename F>
+constexpr F reduced_sqrt(F x)
+{
+  F r = (x + 1) / 2;
+  for(F next = (r + x / r) / 2; next < r; next = (r + x / r) / 2)
+    r = next;
+
+  //the nearest of r and its neighbours
+  constexpr F ulp = std::numeric_limits<F>::epsilon();
+  F best = r;
+  for(F candidate : {r - ulp, r + ulp})
+    if(abs(square_residual(candidate, x)) < abs(square_residual(best, x)))
+      best = candidate;
+  return best;
+}
+
+
+//x in [1, 2^n) : the root is in [1, 2)
+template <typename F>
+constexpr F reduced_nroot(F x, int n)
+{
+  F r = 2;
+  F basis = static_cast<F>(n);
+  for(F next = ((basis - 1) * r + x / pow(r, n - 1)) / basis; next < r; next = ((basis - 1) * r + x / pow(r, n - 1)) / basis)
+    r = next;
+
+  constexpr F ulp = std::numeric_limits<F>::epsilon();
+  F best = r;
+  for(F candidate : {r - ulp, r + ulp})
+    if(abs(pow(candidate, n) - x) < abs(pow(best, n) - x))
+      best = candidate;
+  return best;
+}
+
+
+//runtime : steps r by ulps toward the nearest n-th power to x (std::pow may be a few ulps off)
+template <typename F>
+F nearest_root(F r, F x, int n)
+{
+  F toward = pow(r, n) < x ? std::numeric_limits<F>::infinity() : F(0);
+  for(F next = std::nextafter(r, toward); abs(pow(next, n) - x) < abs(pow(r, n) - x); next = std::nextafter(r, toward))
+    r = next;
+  return r;
+}
+
+
+} //namespace detail
+
+
+template <typename T>
+constexpr computed_t<T> sqrt(T x)
+{
+  static_assert(std::is_arithmetic<typename computation<T>::type>::value, "Argument should be an arithmetic value, or a representation computed as one.");
+  typedef computed_t<T> F;
+  F y = static_cast<F>(computation<T>::value(x));
+  if(!OMNI_CONSTANT_EVALUATED())
+    return std::sqrt(y);
+
+  if(detail::is_nan(y) || detail::same(y, F(0)) || detail::same(y, std::numeric_limits<F>::infinity()))
+    return y;
+  if(y < 0)
+    return std::numeric_limits<F>::quiet_NaN();
+
+  //scaling by powers of 4 is exact, and halves the exponent of the root
+  F scale = 1;
+  while(y >= 4)
+  {
+    y /= 4;
+    scale *= 2;
+  }
+  while(y < 1)
+  {
+    y *= 4;
+    scale /= 2;
+  }
+  return detail::reduced_sqrt(y) * scale;
+}
+
+
+//root of basis n, negative n being the inverse root
+template <typename T>
+constexpr computed_t<T> nroot(T x, int n)
+{
+  static_assert(std::is_arithmetic<typename computation<T>::type>::value, "Argument should be an arithmetic value, or a representation computed as one.");
+  typedef computed_t<T> F;
+  F y = static_cast<F>(computation<T>::value(x));
+
+  //same signs and special values at compile time and at runtime
+  if(n < 0)
+    return 1 / nroot(y, -n);
+  if(n == 0 || detail::is_nan(y))
+    return std::numeric_limits<F>::quiet_NaN();
+  if(n == 1 || detail::same(y, F(0)) || detail::same(y, std::numeric_limits<F>::infinity()))
+    return y;
+  if(y < 0)
+    return n % 2 == 1 ? -nroot(-y, n) : std::numeric_limits<F>::quiet_NaN();
+  if(n == 2)
+    return sqrt(y);
+  if(!OMNI_CONSTANT_EVALUATED())
+    return detail::nearest_root(n == 3 ? std::cbrt(y) : std::pow(y, static_cast<F>(1) / static_cast<F>(n)), y, n);
+
+  //scaling by powers of 2^n is exact, and doubles (or halves) the root
+  F step = pow(static_cast<F>(2), n);
+  F scale = 1;
+  while(y >= step)
+  {
+    y /= step;
+    scale *= 2;
+  }
+  while(y < 1)
+  {
+    y *= step;
+    scale /= 2;
+  }
+  return detail::reduced_nroot(y, n) * scale;
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== LOGARITHM ===============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <typename T>
+constexpr computed_t<T> log10(T x)
+{
+  static_assert(std::is_arithmetic<typename computation<T>::type>::value, "Argument should be an arithmetic value, or a representation computed as one.");
+  typedef computed_t<T> F;
+  F y = static_cast<F>(computation<T>::value(x));
+  if(!OMNI_CONSTANT_EVALUATED())
+    return std::log10(y);
+
+  if(detail::is_nan(y) || y < 0)
+    return std::numeric_limits<F>::quiet_NaN();
+  if(detail::same(y, F(0)))
+    return -std::numeric_limits<F>::infinity();
+  if(detail::same(y, std::numeric_limits<F>::infinity()))
+    return y;
+
+  //y = m * 2^e with m in [1, 2), exactly
+  int e = 0;
+  F m = y;
+  while(m >= 2)
+  {
+    m /= 2;
+    e++;
+  }
+  while(m < 1)
+  {
+    m *= 2;
+    e--;
+  }
+
+  //ln(m) = 2 atanh((m-1)/(m+1)), (m-1)/(m+1) < 1/3
+  long double s = static_cast<long double>(m - 1) / static_cast<long double>(m + 1);
+  long double s2 = s * s;
+  long double term = s;
+  long double ln = 0;
+  for(int k = 1; term > std::numeric_limits<long double>::epsilon() * ln / 4 || k == 1; k += 2)
+  {
+    ln += term / k;
+    term *= s2;
+  }
+  ln *= 2;
+
+  constexpr long double ln2 = 0.693147180559945309417232121458176568L;
+  constexpr long double ln10 = 2.302585092994045684017999904740405436L;
+  F result = static_cast<F>((e * ln2 + ln) / ln10);
+
+  //powers of ten that are exact in floating point give exact exponents
+  F n = round(result);
+  if(abs(n) <= 22)
+  {
+    F power = pow(static_cast<F>(10), static_cast<int>(abs(n)));
+    if(detail::same(y, n >= 0 ? power : 1 / power))
+      return n;
+  }
+  return result;
+}
+
+
+
+} //namespace math
+} //namespace omni
+
+#endif //OMNIUNIT_MATH_HH_
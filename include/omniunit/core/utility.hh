@@ -38,7 +38,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define OMNIUNIT_UTILITY_HH_
 
 
+#include "../settings.hh"
+#include "math.hh"
+
 #include <cmath>
+#include <cstdint>
 #include <limits>
 #include <ratio>
 #include <string>
@@ -149,7 +153,7 @@ modulo(T const& a, U const& b)
   typedef typename std::common_type<T, U>::type common;
   common a2 = static_cast<common>(a);
   common b2 = static_cast<common>(b);
-  return a2 - (static_cast<common>(std::floor(a2/b2)) * b2);
+  return a2 - (static_cast<common>(math::floor(a2/b2)) * b2);
 }
 
 
@@ -165,7 +169,7 @@ gcd(T const& a, U const& b)
   common b2 = static_cast<common>(b);
 
   double temp = 0;
-  while (std::abs(b2) > InternEpsilon<common>::value)
+  while (math::abs(b2) > InternEpsilon<common>::value)
   {
     temp = modulo(a2, b2);
     a2 = b2;
@@ -180,8 +184,44 @@ template <typename T>
 constexpr bool is_positive_integer(T const& number)
 {
   static_assert(std::is_arithmetic<T>::value, "Arguments should be arithmetic values.");
-  T res = number - static_cast<T>(std::floor(number));
-  return (std::abs(res) <= InternEpsilon<T>::value && number >= 0);
+  T res = number - static_cast<T>(math::floor(number));
+  return (math::abs(res) <= InternEpsilon<T>::value && number >= 0);
+}
+
+
+//gcd of two positive integer-valued doubles.
+//Below 2^64, doubles are converted to integers without loss, and the gcd is
+//computed exactly on them. Above, they are only approximations of the numbers
+//they were written for (like E36 for 10^36), so the floating gcd is used.
+constexpr double exact_gcd(double a, double b)
+{
+  if(a >= 18446744073709551616. || b >= 18446744073709551616.) // 2^64
+    return gcd(a, b);
+
+  unsigned long long a2 = static_cast<unsigned long long>(a);
+  unsigned long long b2 = static_cast<unsigned long long>(b);
+  while(b2 != 0)
+  {
+    unsigned long long temp = a2 % b2;
+    a2 = b2;
+    b2 = temp;
+  }
+  return static_cast<double>(a2);
+}
+
+
+//power of a double by squaring, exact as long as the result is representable
+constexpr double integer_power(double number, unsigned exponent)
+{
+  double result = 1.;
+  while(exponent != 0)
+  {
+    if(exponent % 2 == 1)
+      result *= number;
+    number *= number;
+    exponent /= 2;
+  }
+  return result;
 }
 
 
@@ -197,6 +237,52 @@ constexpr long long unsigned operator"" _fact(unsigned long long n) {return fact
 
 
 
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== INTEGER ARITHMETIC ======================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//how conversions between integer representations round (see OMNI_INTEGER_ROUNDING).
+//Nearest rounds halfway cases away from zero.
+enum class Rounding {TowardZero, Nearest, Down, Up};
+
+
+//true if quotient + remainder / divisor (with 0 <= remainder < divisor) rounds to
+//quotient + 1 rather than to quotient. negative is the sign of the exact value.
+constexpr bool rounds_up(bool negative, std::intmax_t remainder, std::intmax_t divisor, Rounding rounding)
+{
+  if(remainder == 0 || rounding == Rounding::Down)
+    return false;
+  if(rounding == Rounding::Up)
+    return true;
+  if(rounding == Rounding::TowardZero)
+    return negative;
+  std::intmax_t rest = divisor - remainder;
+  return remainder > rest || (remainder == rest && !negative);
+}
+
+
+//same rounding for a floating point
+template <typename T>
+constexpr T round_value(T value, Rounding rounding)
+{
+  switch(rounding)
+  {
+    case Rounding::Down: return math::floor(value);
+    case Rounding::Up: return math::ceil(value);
+    case Rounding::Nearest: return math::round(value);
+    case Rounding::TowardZero: return math::trunc(value);
+    default: return math::trunc(value);
+  }
+}
+
+
+
 //=============================================================================
 //=============================================================================
 //=============================================================================
@@ -313,6 +399,11 @@ inline constexpr double E90 = 10000000000000000000000000000000000000000000000000
 
 
 
+//num and den are integer-valued doubles : every product or quotient of ratios
+//is exact as long as its reduced terms stay below 2^53, which covers every
+//combination of prefixes up to yotta. Above that (pi, tau, yotta^2...), the
+//terms are rounded to the nearest double and exact is false. Ratios are not
+//integer (or 128 bits) types : they stay keyed by the E0...E90 double constants.
 template<double const& _Num, double const& _Den>
 struct Ratio
 {
@@ -320,9 +411,13 @@ struct Ratio
   static_assert(is_positive_integer(_Den), "Denominator may not have decimals and may be positive.");
   static_assert(_Den > InternEpsilon<double>::value, "Denominator cannot be zero.");
 
-  static constexpr double num = _Num / gcd(_Num, _Den);
-  static constexpr double den = _Den / gcd(_Num, _Den);
+private:
+  static constexpr double _gcd = exact_gcd(_Num, _Den);
+public:
+  static constexpr double num = _Num / _gcd;
+  static constexpr double den = _Den / _gcd;
   inline static constexpr double value = num / den;
+  static constexpr bool exact = num <= 9007199254740992. && den <= 9007199254740992.; // 2^53
   typedef Ratio<num, den> type;
 };
 
@@ -353,21 +448,24 @@ struct is_stb_Ratio<Ratio<Num, Den>> : public std::true_type
 template <typename ratio>
 class Ratio_invert
 {
-  static_assert(std::abs(ratio::num) > InternEpsilon<double>::value, "Denominator cannot be zero.");
+  static_assert(math::abs(ratio::num) > InternEpsilon<double>::value, "Denominator cannot be zero.");
   static_assert(is_stb_Ratio<ratio>::value , "Template parameter should be an OmniUnit ratio.");
 public:
   typedef Ratio<ratio::den, ratio::num> type;
 };
 
 
+//operands are reduced crosswise before being multiplied, like std::ratio_multiply does,
+//so that the product stays as small (and as exact) as possible.
 template <typename ratio1, typename ratio2>
 class Ratio_times_Ratio
 {
   static_assert(is_stb_Ratio<ratio1>::value && is_stb_Ratio<ratio2>::value, "Template parameters should be OmniUnit ratios.");
 
-  static constexpr double _gcd = gcd(ratio1::num * ratio2::num, ratio1::den * ratio2::den);
-  static constexpr double num = (ratio1::num * ratio2::num) / _gcd;
-  static constexpr double den = (ratio1::den * ratio2::den) / _gcd;
+  static constexpr double _gcd1 = exact_gcd(ratio1::num, ratio2::den);
+  static constexpr double _gcd2 = exact_gcd(ratio2::num, ratio1::den);
+  static constexpr double num = (ratio1::num / _gcd1) * (ratio2::num / _gcd2);
+  static constexpr double den = (ratio1::den / _gcd2) * (ratio2::den / _gcd1);
 public:
   typedef Ratio<num, den> type;
 };
@@ -379,8 +477,8 @@ class Ratio_times_value
   static_assert(is_stb_Ratio<ratio>::value, "First template parameter should be an OmniUnit ratio.");
   static_assert(is_positive_integer(val), "Second template parameter may not have decimals and may be positive.");
 
-  static constexpr double _gcd = gcd(ratio::num * val, ratio::den);
-  static constexpr double num = (ratio::num * val) / _gcd;
+  static constexpr double _gcd = exact_gcd(val, ratio::den);
+  static constexpr double num = ratio::num * (val / _gcd);
   static constexpr double den = ratio::den / _gcd;
 public:
   typedef Ratio<num, den> type;
@@ -400,12 +498,13 @@ public:
 template <typename ratio1, typename ratio2>
 class Ratio_over_Ratio
 {
-  static_assert(std::abs(ratio2::num) > InternEpsilon<double>::value, "Denominator cannot be zero.");
+  static_assert(math::abs(ratio2::num) > InternEpsilon<double>::value, "Denominator cannot be zero.");
   static_assert(is_stb_Ratio<ratio1>::value && is_stb_Ratio<ratio2>::value, "Template parameters should be OmniUnit ratios.");
 
-  static constexpr double _gcd = gcd(ratio1::num * ratio2::den, ratio1::den * ratio2::num);
-  static constexpr double num = (ratio1::num * ratio2::den) / _gcd;
-  static constexpr double den = (ratio1::den * ratio2::num) /_gcd;
+  static constexpr double _gcd1 = exact_gcd(ratio1::num, ratio2::num);
+  static constexpr double _gcd2 = exact_gcd(ratio2::den, ratio1::den);
+  static constexpr double num = (ratio1::num / _gcd1) * (ratio2::den / _gcd2);
+  static constexpr double den = (ratio1::den / _gcd2) * (ratio2::num / _gcd1);
 public:
   typedef Ratio<num, den> type;
 };
@@ -414,13 +513,13 @@ public:
 template <typename ratio, double const& val>
 class Ratio_over_value
 {
-  static_assert(std::abs(val) > InternEpsilon<double>::value, "Denominator cannot be zero.");
+  static_assert(math::abs(val) > InternEpsilon<double>::value, "Denominator cannot be zero.");
   static_assert(is_stb_Ratio<ratio>::value, "First template parameter should be an OmniUnit ratio.");
   static_assert(is_positive_integer(val), "Second template parameter may not have decimals and may be positive.");
 
-  static constexpr double _gcd = gcd(ratio::num, ratio::den * val);
+  static constexpr double _gcd = exact_gcd(ratio::num, val);
   static constexpr double num = ratio::num / _gcd;
-  static constexpr double den = (ratio::den * val) /_gcd;
+  static constexpr double den = ratio::den * (val / _gcd);
 public:
   typedef Ratio<num, den> type;
 };
@@ -429,26 +528,27 @@ public:
 template <double const& val, typename ratio>
 class value_over_Ratio
 {
-  static_assert(std::abs(ratio::num) > InternEpsilon<double>::value, "Denominator cannot be zero.");
+  static_assert(math::abs(ratio::num) > InternEpsilon<double>::value, "Denominator cannot be zero.");
   static_assert(is_stb_Ratio<ratio>::value, "Second template parameter should be an OmniUnit ratio.");
   static_assert(is_positive_integer(val), "First template parameter may not have decimals and may be positive.");
 
-  static constexpr double _gcd = gcd(val * ratio::den, ratio::num);
-  static constexpr double num = (val * ratio::den) / _gcd;
-  static constexpr double den = (ratio::den * val) /_gcd;
+  static constexpr double _gcd = exact_gcd(val, ratio::num);
+  static constexpr double num = (val / _gcd) * ratio::den;
+  static constexpr double den = ratio::num / _gcd;
 public:
   typedef Ratio<num, den> type;
 };
 
 
+//num and den are coprime, so are their powers : no reduction is needed.
 template <typename ratio, int exponent>
 class Ratio_power
 {
   static_assert(is_stb_Ratio<ratio>::value, "First template parameter should be an OmniUnit ratio.");
 
-  static constexpr double _gcd = gcd(std::pow(ratio::num, exponent), std::pow(ratio::den, exponent));
-  static constexpr double num = std::pow(ratio::num, exponent) / _gcd;
-  static constexpr double den = std::pow(ratio::den, exponent) /_gcd;
+  static constexpr unsigned _exponent = static_cast<unsigned>(exponent < 0 ? -exponent : exponent);
+  static constexpr double num = integer_power(exponent < 0 ? ratio::den : ratio::num, _exponent);
+  static constexpr double den = integer_power(exponent < 0 ? ratio::num : ratio::den, _exponent);
 public:
   typedef Ratio<num, den> type;
 };
@@ -460,9 +560,9 @@ class Ratio_root
   static_assert(is_stb_Ratio<ratio>::value, "First template parameter should be an OmniUnit ratio.");
   static_assert(basis != 0, "Basis must not be 0.");
 
-  static constexpr double _gcd = gcd(std::pow(ratio::num, 1.0/basis), std::pow(ratio::den, 1.0/basis));
-  static constexpr double num = std::pow(ratio::num, 1.0/basis) / _gcd;
-  static constexpr double den = std::pow(ratio::den, 1.0/basis) /_gcd;
+  static constexpr double _gcd = gcd(math::nroot(ratio::num, basis), math::nroot(ratio::den, basis));
+  static constexpr double num = math::nroot(ratio::num, basis) / _gcd;
+  static constexpr double den = math::nroot(ratio::den, basis) /_gcd;
 public:
   typedef Ratio<num, den> type;
 };
@@ -649,13 +749,13 @@ struct Dimension_root
   static_assert(basis != 0, "Basis must not be 0.");
 
   static_assert(
-  std::abs(modulo(static_cast<double>(dim::length) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
-  std::abs(modulo(static_cast<double>(dim::mass) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
-  std::abs(modulo(static_cast<double>(dim::time) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
-  std::abs(modulo(static_cast<double>(dim::current) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
-  std::abs(modulo(static_cast<double>(dim::temperature) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
-  std::abs(modulo(static_cast<double>(dim::quantity) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
-  std::abs(modulo(static_cast<double>(dim::luminous_intensity) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value,
+  math::abs(modulo(static_cast<double>(dim::length) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
+  math::abs(modulo(static_cast<double>(dim::mass) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
+  math::abs(modulo(static_cast<double>(dim::time) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
+  math::abs(modulo(static_cast<double>(dim::current) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
+  math::abs(modulo(static_cast<double>(dim::temperature) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
+  math::abs(modulo(static_cast<double>(dim::quantity) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value &&
+  math::abs(modulo(static_cast<double>(dim::luminous_intensity) / static_cast<double>(basis), 1)) <= InternEpsilon<double>::value,
   "Cannot root this dimension with this basis (some values may not be integers).");
 
   typedef Dimension<
@@ -722,15 +822,16 @@ struct origin_product
 template<double const& a, double const& b>
 struct origin_division
 {
-  //static_assert(std::abs(b) > InternEpsilon<double>::value, "Dividing Origin by 0.");
-  inline static constexpr double value = (OMNI_TRUE_ZERO || std::abs(b) <= InternEpsilon<double>::value) ? zero : a/b;
+  //static_assert(math::abs(b) > InternEpsilon<double>::value, "Dividing Origin by 0.");
+  inline static constexpr double value = (OMNI_TRUE_ZERO || math::abs(b) <= InternEpsilon<double>::value) ? zero : a/b;
 };
 
 
 template<double const& origin, int exponent>
 struct origin_power
 {
-  inline static constexpr double value = std::pow(origin, exponent);
+  //like origin_division, a zero origin stays zero with a negative exponent
+  inline static constexpr double value = (exponent < 0 && math::abs(origin) <= InternEpsilon<double>::value) ? zero : math::pow(origin, exponent);
 };
 
 
@@ -738,7 +839,7 @@ template<double const& origin, int basis>
 struct origin_root
 {
   static_assert(basis != 0, "Basis must not be 0.");
-  inline static constexpr double value = std::pow(origin, 1.0/basis);
+  inline static constexpr double value = math::nroot(origin, basis);
 };
 
 
@@ -760,15 +861,15 @@ constexpr double getDeviation(double variation, Law law)
   if(law == Law::None || law == Law::Normal)
     return variation;
   else if(law == Law::Uniform)
-    return variation / std::sqrt(3.);
+    return variation / math::sqrt(3.);
   else if(law == Law::Triangular)
-    return variation / std::sqrt(6.);
+    return variation / math::sqrt(6.);
   else if(law == Law::Asymetric)
-    return variation / (3. * std::sqrt(2.));
+    return variation / (3. * math::sqrt(2.));
   else if(law == Law::Arcsinus)
-    return variation / std::sqrt(2.);
+    return variation / math::sqrt(2.);
   else if(law == Law::Uniform_gap)
-    return variation / (2. * std::sqrt(3.));
+    return variation / (2. * math::sqrt(3.));
 }
 
 
@@ -788,11 +889,11 @@ constexpr std::initializer_list<double> getMeanAndDeviation(container_t const& O
 
     // non-biased variance
     for(unsigned count = 0; count < Obj.size(); count++)
-      deviation += std::pow(static_cast<double>(Obj[count]) - mean, 2);
+      deviation += math::pow(static_cast<double>(Obj[count]) - mean, 2);
 
     if(Obj.size() > 1)
       deviation /= static_cast<double>(Obj.size()-1);
-    deviation = std::sqrt(deviation/static_cast<double>(Obj.size()))* quantile(Obj.size() - 1);
+    deviation = math::sqrt(deviation/static_cast<double>(Obj.size()))* quantile(Obj.size() - 1);
   }
 
   // systematic error
@@ -804,12 +905,12 @@ constexpr std::initializer_list<double> getMeanAndDeviation(container_t const& O
   else
   {
     for(unsigned count = 0; count < systErr.size(); count++)
-      syst += std::pow(static_cast<double>(systErr[count]), 2);
-    syst = std::sqrt(syst);
+      syst += math::pow(static_cast<double>(systErr[count]), 2);
+    syst = math::sqrt(syst);
   }
 
   //return the mean and the absolute confidence interval at 1 sigma
-  return {std::sqrt(std::pow(mean, 2) + std::pow(syst, 2)), deviation};
+  return {math::sqrt(math::pow(mean, 2) + math::pow(syst, 2)), deviation};
 }
 
 
@@ -0,0 +1,560 @@
+//eigen.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_EIGEN_HH_
+#define OMNIUNIT_EIGEN_HH_
+
+// interoperability with the Eigen library (3.4, not shipped with OmniUnit) :
+//
+// - Eigen::NumTraits and Eigen::ScalarBinaryOpTraits are specialized for units, so that
+//   Eigen::Matrix<omni::meter<>, 3, 3> is a valid matrix, and products are typed like
+//   the scalar operators (a matrix of meters times a matrix of newtons is a matrix of
+//   joules). As Eigen does not convert scalars implicitly, assign products with auto,
+//   or cast<...>() them to a unit of the same dimension. A Unit holds its uncertainty
+//   beside its count, so Eigen computes these matrices element by element, without
+//   packet math.
+//   Products are limited : a * b only compiles for fixed sizes whose dimensions are all
+//   below EIGEN_CACHEFRIENDLY_PRODUCT_THRESHOLD (8 on most targets, so up to 7x7).
+//   Above, and for dynamic sizes, Eigen selects its blocked product kernels, which
+//   scale their result by a coefficient of the result type, that is by a unit : these
+//   products stop on a static_assert that names the alternatives (the first error for
+//   products of matrices, after a few errors of Eigen for matrix-vector products).
+//   a.lazyProduct(b) compiles at any size, but is an order of magnitude slower than the
+//   same product of UnitMatrix. For the same reason, m *= 2. and m /= 2. stop on a
+//   static_assert : write m = m * 2.
+//
+// - omni::UnitMatrix<U, Rows, Cols> is the supported way to do linear algebra on units.
+//   It stores an Eigen matrix of counts of U, and gives it the same typed operations
+//   (+, -, *, transpose, inverse) at any size, dynamic ones included. Eigen sees plain
+//   double (or float) matrices, which it vectorizes and blocks exactly as it does
+//   without units. counts() gives the Eigen matrix.
+//
+// see bench/eigen_bench.cpp for a comparison of both against raw double matrices.
+
+#include <type_traits>
+#include <utility>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include "core/Unit.hh"
+
+
+
+namespace omni
+{
+namespace eigen_detail
+{
+
+
+template <typename U1, typename U2>
+using sum_t = decltype(std::declval<U1>() + std::declval<U2>());
+
+template <typename U1, typename U2>
+using first_t = U1;
+
+template <typename U1, typename U2>
+using product_t = decltype(std::declval<U1>() * std::declval<U2>());
+
+template <typename U1, typename U2>
+using quotient_t = decltype(std::declval<U1>() / std::declval<U2>());
+
+
+//ReturnType of a unit and a coefficient, absent for anything else (Eigen probes
+//ScalarBinaryOpTraits with matrices in SFINAE contexts)
+template <typename A, typename B, template <typename, typename> class result_t, bool = (std::is_arithmetic<A>::value || std::is_arithmetic<B>::value)>
+struct scaling_traits
+{
+};
+
+
+template <typename A, typename B, template <typename, typename> class result_t>
+struct scaling_traits<A, B, result_t, true>
+{
+  typedef result_t<A, B> ReturnType;
+};
+
+
+} //namespace eigen_detail
+} //namespace omni
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== EIGEN TRAITS ============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+namespace Eigen
+{
+
+
+template <typename Dimension, typename Rep, typename Period, double const& Origin>
+struct NumTraits<omni::Unit<Dimension, Rep, Period, Origin>>
+{
+  typedef omni::Unit<Dimension, Rep, Period, Origin> Real;
+  typedef omni::Unit<Dimension, typename NumTraits<Rep>::NonInteger, Period, Origin> NonInteger;
+  typedef Real Nested;
+  typedef Rep Literal;
+
+  enum
+  {
+    IsComplex = 0,
+    IsInteger = NumTraits<Rep>::IsInteger,
+    IsSigned = NumTraits<Rep>::IsSigned,
+    RequireInitialization = 1,
+    ReadCost = 2 * NumTraits<Rep>::ReadCost,
+    AddCost = NumTraits<Rep>::AddCost,
+    MulCost = NumTraits<Rep>::MulCost
+  };
+
+  static inline int digits10()
+  {
+    return NumTraits<Rep>::digits10();
+  }
+
+  static inline Real epsilon()
+  {
+    return Real(NumTraits<Rep>::epsilon());
+  }
+
+  static inline Real dummy_precision()
+  {
+    return Real(NumTraits<Rep>::dummy_precision());
+  }
+
+  static inline Real highest()
+  {
+    return Real(NumTraits<Rep>::highest());
+  }
+
+  static inline Real lowest()
+  {
+    return Real(NumTraits<Rep>::lowest());
+  }
+
+  static inline Real infinity()
+  {
+    return Real(NumTraits<Rep>::infinity());
+  }
+
+  static inline Real quiet_NaN()
+  {
+    return Real(NumTraits<Rep>::quiet_NaN());
+  }
+};
+
+
+//unit op unit : the two units may be the same type, which Eigen's own <T, T, BinaryOp> matches as well.
+//The sum of two units of the same type is given that type, so that matrices can be assigned without cast
+#define OMNI_EIGEN_BINARY_OP(op, result_t, same_t) \
+template <typename Dimension1, typename Rep1, typename Period1, double const& Origin1, \
+          typename Dimension2, typename Rep2, typename Period2, double const& Origin2> \
+struct ScalarBinaryOpTraits<omni::Unit<Dimension1, Rep1, Period1, Origin1>, omni::Unit<Dimension2, Rep2, Period2, Origin2>, \
+  internal::op<omni::Unit<Dimension1, Rep1, Period1, Origin1>, omni::Unit<Dimension2, Rep2, Period2, Origin2>>> \
+{ \
+  typedef omni::eigen_detail::result_t<omni::Unit<Dimension1, Rep1, Period1, Origin1>, omni::Unit<Dimension2, Rep2, Period2, Origin2>> ReturnType; \
+}; \
+\
+template <typename Dimension, typename Rep, typename Period, double const& Origin> \
+struct ScalarBinaryOpTraits<omni::Unit<Dimension, Rep, Period, Origin>, omni::Unit<Dimension, Rep, Period, Origin>, \
+  internal::op<omni::Unit<Dimension, Rep, Period, Origin>, omni::Unit<Dimension, Rep, Period, Origin>>> \
+{ \
+  typedef omni::eigen_detail::same_t<omni::Unit<Dimension, Rep, Period, Origin>, omni::Unit<Dimension, Rep, Period, Origin>> ReturnType; \
+};
+
+OMNI_EIGEN_BINARY_OP(scalar_sum_op, sum_t, first_t)
+OMNI_EIGEN_BINARY_OP(scalar_difference_op, sum_t, first_t)
+OMNI_EIGEN_BINARY_OP(scalar_product_op, product_t, product_t)
+OMNI_EIGEN_BINARY_OP(scalar_conj_product_op, product_t, product_t)
+OMNI_EIGEN_BINARY_OP(scalar_quotient_op, quotient_t, quotient_t)
+
+#undef OMNI_EIGEN_BINARY_OP
+
+
+//unit op arithmetic, arithmetic op unit (scaling by a coefficient)
+#define OMNI_EIGEN_SCALAR_OP(op, result_t) \
+template <typename Dimension, typename Rep, typename Period, double const& Origin, typename T> \
+struct ScalarBinaryOpTraits<omni::Unit<Dimension, Rep, Period, Origin>, T, internal::op<omni::Unit<Dimension, Rep, Period, Origin>, T>> : \
+  omni::eigen_detail::scaling_traits<omni::Unit<Dimension, Rep, Period, Origin>, T, omni::eigen_detail::result_t> \
+{ \
+}; \
+\
+template <typename T, typename Dimension, typename Rep, typename Period, double const& Origin> \
+struct ScalarBinaryOpTraits<T, omni::Unit<Dimension, Rep, Period, Origin>, internal::op<T, omni::Unit<Dimension, Rep, Period, Origin>>> : \
+  omni::eigen_detail::scaling_traits<T, omni::Unit<Dimension, Rep, Period, Origin>, omni::eigen_detail::result_t> \
+{ \
+};
+
+OMNI_EIGEN_SCALAR_OP(scalar_product_op, product_t)
+OMNI_EIGEN_SCALAR_OP(scalar_quotient_op, quotient_t)
+
+#undef OMNI_EIGEN_SCALAR_OP
+
+
+namespace internal
+{
+
+
+//Eigen assumes that a scalar times the same scalar is that scalar (x * x is in square meters)
+#define OMNI_EIGEN_CONJ_HELPER(ConjLhs, ConjRhs) \
+template <typename Dimension, typename Rep, typename Period, double const& Origin> \
+struct conj_helper<omni::Unit<Dimension, Rep, Period, Origin>, omni::Unit<Dimension, Rep, Period, Origin>, ConjLhs, ConjRhs> \
+{ \
+  typedef omni::Unit<Dimension, Rep, Period, Origin> unit; \
+  typedef omni::eigen_detail::product_t<unit, unit> ResultType; \
+\
+  ResultType pmadd(unit const& x, unit const& y, ResultType const& c) const \
+  { \
+    return x * y + c; \
+  } \
+\
+  ResultType pmul(unit const& x, unit const& y) const \
+  { \
+    return x * y; \
+  } \
+};
+
+OMNI_EIGEN_CONJ_HELPER(false, false)
+OMNI_EIGEN_CONJ_HELPER(false, true)
+OMNI_EIGEN_CONJ_HELPER(true, false)
+OMNI_EIGEN_CONJ_HELPER(true, true)
+
+#undef OMNI_EIGEN_CONJ_HELPER
+
+
+//m *= coef and m /= coef give coef the type of the components, which a unit cannot be multiplied by in place
+#define OMNI_EIGEN_SCALING_ASSIGN(op, symbol) \
+template <typename Dimension, typename Rep, typename Period, double const& Origin> \
+struct op<omni::Unit<Dimension, Rep, Period, Origin>, omni::Unit<Dimension, Rep, Period, Origin>> \
+{ \
+  typedef omni::Unit<Dimension, Rep, Period, Origin> unit; \
+\
+  void assignCoeff(unit& a, unit const&) const \
+  { \
+    static_assert(!omni::is_Unit<unit>::value, \
+      "Eigen matrices of units cannot be scaled in place : write m = m " symbol " coef rather than m " symbol "= coef, or use omni::UnitMatrix."); \
+    a = unit(); \
+  } \
+};
+
+OMNI_EIGEN_SCALING_ASSIGN(mul_assign_op, "*")
+OMNI_EIGEN_SCALING_ASSIGN(div_assign_op, "/")
+
+#undef OMNI_EIGEN_SCALING_ASSIGN
+
+
+} //namespace internal
+
+
+} //namespace Eigen
+
+
+
+namespace omni
+{
+
+
+//The blocked product kernels of Eigen (GEMM, GEMV) scale their result by a coefficient of the
+//result type, that is by a unit. They combine it with the factors of the operands through an
+//unqualified call, which finds this overload by ADL and stops the product with a readable message.
+//Being constexpr, it is instantiated (and fails) before the kernels themselves.
+template <typename Dimension, typename Rep, typename Period, double const& Origin, typename Lhs, typename Rhs>
+constexpr Unit<Dimension, Rep, Period, Origin> combine_scalar_factors(Unit<Dimension, Rep, Period, Origin> const& alpha, Lhs const&, Rhs const&)
+{
+  static_assert(!is_Unit<Unit<Dimension, Rep, Period, Origin>>::value,
+    "Products of Eigen matrices of units only compile for fixed sizes below EIGEN_CACHEFRIENDLY_PRODUCT_THRESHOLD (up to 7x7) : use a.lazyProduct(b), or omni::UnitMatrix.");
+  return alpha;
+}
+
+
+} //namespace omni
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== MATRICES OF COUNTS ======================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+namespace omni
+{
+
+
+template <typename U, int Rows, int Cols>
+class UnitMatrix;
+
+
+namespace eigen_detail
+{
+
+
+//counts of m in the period of U : the counts themselves when the conversion is exact
+template <typename U, typename U2, int Rows, int Cols>
+decltype(auto) counts_in(UnitMatrix<U2, Rows, Cols> const& m)
+{
+  typedef typename U::rep rep;
+  typedef Conversion<U2, U> conv;
+
+  if constexpr(std::is_same<rep, typename U2::rep>::value && conv::num <= conv::den && conv::num >= conv::den)
+    return m.counts();
+  else
+    return m.counts().template cast<rep>() * static_cast<rep>(conv::num / conv::den);
+}
+
+
+} //namespace eigen_detail
+
+
+template <typename U, int Rows, int Cols>
+class UnitMatrix
+{
+  static_assert(is_Unit<U>::value, "Components of a UnitMatrix should be units.");
+  static_assert(std::is_floating_point<typename U::rep>::value, "UnitMatrix needs a floating point Rep.");
+  static_assert(U::origin <= 0. && U::origin >= 0., "UnitMatrix needs units with a zero origin.");
+
+public:
+  typedef U unit;
+  typedef typename U::rep rep;
+  typedef Eigen::Matrix<rep, Rows, Cols> counts_type;
+
+
+  //null matrix
+  UnitMatrix():
+  _counts(counts_type::Zero())
+  {
+  }
+
+
+  //counts in the period of U
+  template <typename Derived>
+  explicit UnitMatrix(Eigen::MatrixBase<Derived> const& counts):
+  _counts(counts)
+  {
+  }
+
+
+  //conversion from a matrix of another unit of the same dimension
+  template <typename U2, typename = typename std::enable_if<!std::is_same<U, U2>::value>::type>
+  UnitMatrix(UnitMatrix<U2, Rows, Cols> const& other):
+  _counts(eigen_detail::counts_in<U>(other))
+  {
+  }
+
+
+  static UnitMatrix Identity()
+  {
+    return UnitMatrix(counts_type::Identity());
+  }
+
+
+  Eigen::Index rows() const
+  {
+    return _counts.rows();
+  }
+
+
+  Eigen::Index cols() const
+  {
+    return _counts.cols();
+  }
+
+
+  U operator()(Eigen::Index row, Eigen::Index col) const
+  {
+    return U(_counts(row, col));
+  }
+
+
+  void set(Eigen::Index row, Eigen::Index col, U const& value)
+  {
+    _counts(row, col) = value.count();
+  }
+
+
+  counts_type const& counts() const
+  {
+    return _counts;
+  }
+
+
+  counts_type& counts()
+  {
+    return _counts;
+  }
+
+
+  UnitMatrix<U, Cols, Rows> transpose() const
+  {
+    return UnitMatrix<U, Cols, Rows>(_counts.transpose());
+  }
+
+
+  //in the inverse unit of U
+  UnitMatrix<eigen_detail::quotient_t<Unit<Dimension<0,0,0,0,0,0,0>, rep, base, zero>, U>, Rows, Cols> inverse() const
+  {
+    return UnitMatrix<eigen_detail::quotient_t<Unit<Dimension<0,0,0,0,0,0,0>, rep, base, zero>, U>, Rows, Cols>(_counts.inverse());
+  }
+
+
+  template <typename U2>
+  UnitMatrix& operator+=(UnitMatrix<U2, Rows, Cols> const& other)
+  {
+    _counts += eigen_detail::counts_in<U>(other);
+    return *this;
+  }
+
+
+  template <typename U2>
+  UnitMatrix& operator-=(UnitMatrix<U2, Rows, Cols> const& other)
+  {
+    _counts -= eigen_detail::counts_in<U>(other);
+    return *this;
+  }
+
+
+  template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+  UnitMatrix& operator*=(T const& coef)
+  {
+    _counts *= static_cast<rep>(coef);
+    return *this;
+  }
+
+
+private:
+  counts_type _counts;
+};
+
+
+template <typename falseType>
+struct is_UnitMatrix : std::false_type
+{
+};
+
+
+template <typename U, int Rows, int Cols>
+struct is_UnitMatrix<UnitMatrix<U, Rows, Cols>> : std::true_type
+{
+};
+
+
+template <typename U1, typename U2, int Rows, int Cols>
+auto operator+(UnitMatrix<U1, Rows, Cols> const& a, UnitMatrix<U2, Rows, Cols> const& b)
+{
+  typedef UnitMatrix<eigen_detail::sum_t<U1, U2>, Rows, Cols> result;
+  return result(eigen_detail::counts_in<typename result::unit>(a) + eigen_detail::counts_in<typename result::unit>(b));
+}
+
+
+template <typename U1, typename U2, int Rows, int Cols>
+auto operator-(UnitMatrix<U1, Rows, Cols> const& a, UnitMatrix<U2, Rows, Cols> const& b)
+{
+  typedef UnitMatrix<eigen_detail::sum_t<U1, U2>, Rows, Cols> result;
+  return result(eigen_detail::counts_in<typename result::unit>(a) - eigen_detail::counts_in<typename result::unit>(b));
+}
+
+
+template <typename U, int Rows, int Cols>
+UnitMatrix<U, Rows, Cols> operator-(UnitMatrix<U, Rows, Cols> const& m)
+{
+  return UnitMatrix<U, Rows, Cols>(-m.counts());
+}
+
+
+//counts of a product are the products of the counts, in the product of the periods
+template <typename U1, typename U2, int Rows, int Inner, int Cols>
+auto operator*(UnitMatrix<U1, Rows, Inner> const& a, UnitMatrix<U2, Inner, Cols> const& b)
+{
+  typedef eigen_detail::product_t<U1, U2> result;
+  typedef typename result::rep rep;
+  return UnitMatrix<result, Rows, Cols>(a.counts().template cast<rep>() * b.counts().template cast<rep>());
+}
+
+
+template <typename U, int Rows, int Cols, typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+UnitMatrix<U, Rows, Cols> operator*(UnitMatrix<U, Rows, Cols> const& m, T const& coef)
+{
+  return UnitMatrix<U, Rows, Cols>(m.counts() * static_cast<typename U::rep>(coef));
+}
+
+
+template <typename T, typename U, int Rows, int Cols, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+UnitMatrix<U, Rows, Cols> operator*(T const& coef, UnitMatrix<U, Rows, Cols> const& m)
+{
+  return m * coef;
+}
+
+
+template <typename U1, int Rows, int Cols, typename Dimension, typename Rep, typename Period, double const& Origin>
+auto operator*(UnitMatrix<U1, Rows, Cols> const& m, Unit<Dimension, Rep, Period, Origin> const& coef)
+{
+  typedef eigen_detail::product_t<U1, Unit<Dimension, Rep, Period, Origin>> result;
+  typedef typename result::rep rep;
+  return UnitMatrix<result, Rows, Cols>(m.counts().template cast<rep>() * static_cast<rep>(coef.count()));
+}
+
+
+template <typename Dimension, typename Rep, typename Period, double const& Origin, typename U2, int Rows, int Cols>
+auto operator*(Unit<Dimension, Rep, Period, Origin> const& coef, UnitMatrix<U2, Rows, Cols> const& m)
+{
+  typedef eigen_detail::product_t<Unit<Dimension, Rep, Period, Origin>, U2> result;
+  typedef typename result::rep rep;
+  return UnitMatrix<result, Rows, Cols>(static_cast<rep>(coef.count()) * m.counts().template cast<rep>());
+}
+
+
+template <typename left_operande_t, typename U, int Rows, int Cols>
+left_operande_t& operator<<(left_operande_t& left_operande, UnitMatrix<U, Rows, Cols> const& m)
+{
+  left_operande << m.counts();
+  return left_operande;
+}
+
+
+
+} //namespace omni
+
+
+
+#endif //OMNIUNIT_EIGEN_HH_
@@ -0,0 +1,869 @@
+//linalg.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_LINALG_HH_
+#define OMNIUNIT_LINALG_HH_
+
+// small fixed-size vectors and matrices of units : omni::Vec3<omni::meter<>>,
+// omni::Mat3<omni::value<>>... Every component has the same unit, and results
+// follow the scalar operators : dot(Vec3<meter<>>, Vec3<newton<>>) is in joules,
+// Mat3<value<>> * Vec3<meter<>> is a Vec3 of meters.
+//
+// components are stored as counts (no uncertainty), in arrays padded to a power of
+// two and aligned on their size (up to 64 bytes) : a Vec3<meter<double>> is 32
+// bytes, and element-wise operations run on the padding lanes as well so that the
+// compiler vectorizes them. Matrices are column-major, each column padded like a Vec.
+//
+// omni::VecArray<U, N> stores arrays of vectors as structures of arrays (one array
+// of counts per component), and omni::batch::dot, cross, norm and transform run
+// over them.
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "core/Unit.hh"
+
+
+
+namespace omni
+{
+
+
+
+template <typename U, std::size_t N>
+class Vec;
+
+template <typename U, std::size_t Rows, std::size_t Cols>
+class Mat;
+
+
+
+namespace linalg_detail
+{
+
+
+//storage size of N components
+constexpr std::size_t padded(std::size_t size)
+{
+  std::size_t result = 1;
+  while(result < size)
+    result *= 2;
+  return result;
+}
+
+
+//alignment of padded storage, within what operator new handles
+template <typename Rep, std::size_t N>
+inline constexpr std::size_t alignment = ((sizeof(Rep) & (sizeof(Rep) - 1)) != 0 ? alignof(Rep) :
+  (padded(N) * sizeof(Rep) > 64 ? 64 : (padded(N) * sizeof(Rep) < alignof(Rep) ? alignof(Rep) : padded(N) * sizeof(Rep))));
+
+
+template <typename U1, typename U2>
+using sum_t = decltype(std::declval<U1>() + std::declval<U2>());
+
+template <typename U1, typename U2>
+using product_t = decltype(std::declval<U1>() * std::declval<U2>());
+
+template <typename U1, typename U2>
+using quotient_t = decltype(std::declval<U1>() / std::declval<U2>());
+
+
+} //namespace linalg_detail
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== VECTORS =================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <typename U, std::size_t N>
+class Vec
+{
+  static_assert(is_Unit<U>::value, "Components of a Vec should be units.");
+  static_assert(N > 0, "A Vec cannot be empty.");
+
+public:
+  typedef U unit;
+  typedef typename U::rep rep;
+  static constexpr std::size_t padded = linalg_detail::padded(N);
+
+
+  //null vector
+  constexpr Vec():
+  _count{}
+  {
+  }
+
+
+  //Vec3<meter<>>(meter<>(1), centimeter<>(2), inch<>(3))
+  template <typename... Units, typename = typename std::enable_if<(sizeof...(Units) == N && (is_Unit<Units>::value && ...))>::type>
+  constexpr Vec(Units const&... components):
+  _count{static_cast<rep>(U(components).count())...}
+  {
+  }
+
+
+  //conversion from a vector of another unit of the same dimension
+  template <typename U2, typename = typename std::enable_if<!std::is_same<U, U2>::value>::type>
+  constexpr Vec(Vec<U2, N> const& other):
+  _count{}
+  {
+    for(std::size_t i = 0; i < N; i++)
+      _count[i] = U(other[i]).count();
+  }
+
+
+  static constexpr std::size_t size()
+  {
+    return N;
+  }
+
+
+  constexpr U operator[](std::size_t i) const
+  {
+    return U(_count[i]);
+  }
+
+
+  constexpr void set(std::size_t i, U const& value)
+  {
+    _count[i] = value.count();
+  }
+
+
+  //padded counts
+  constexpr rep* data()
+  {
+    return _count;
+  }
+
+
+  constexpr rep const* data() const
+  {
+    return _count;
+  }
+
+
+  template <typename U2>
+  constexpr Vec& operator+=(Vec<U2, N> const& other)
+  {
+    for(std::size_t i = 0; i < padded; i++)
+      _count[i] = U(U(_count[i]) + U2(other.data()[i])).count();
+    return *this;
+  }
+
+
+  template <typename U2>
+  constexpr Vec& operator-=(Vec<U2, N> const& other)
+  {
+    for(std::size_t i = 0; i < padded; i++)
+      _count[i] = U(U(_count[i]) - U2(other.data()[i])).count();
+    return *this;
+  }
+
+
+  template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+  constexpr Vec& operator*=(T const& coef)
+  {
+    for(std::size_t i = 0; i < padded; i++)
+      _count[i] = (U(_count[i]) * coef).count();
+    return *this;
+  }
+
+
+  template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+  constexpr Vec& operator/=(T const& coef)
+  {
+    for(std::size_t i = 0; i < padded; i++)
+      _count[i] = (U(_count[i]) / coef).count();
+    return *this;
+  }
+
+
+private:
+  alignas(linalg_detail::alignment<rep, N>) rep _count[padded];
+};
+
+
+template <typename U>
+using Vec2 = Vec<U, 2>;
+
+template <typename U>
+using Vec3 = Vec<U, 3>;
+
+template <typename U>
+using Vec4 = Vec<U, 4>;
+
+
+template <typename falseType>
+struct is_Vec : std::false_type
+{
+};
+
+
+template <typename U, std::size_t N>
+struct is_Vec<Vec<U, N>> : std::true_type
+{
+};
+
+
+namespace linalg_detail
+{
+
+
+//Result vector of op(i) on every lane, padding included
+template <typename Result, std::size_t N, typename Op>
+constexpr Vec<Result, N> map(Op const& op)
+{
+  Vec<Result, N> result;
+  for(std::size_t i = 0; i < Vec<Result, N>::padded; i++)
+    result.data()[i] = Result(op(i)).count();
+  return result;
+}
+
+
+} //namespace linalg_detail
+
+
+template <typename U, std::size_t N>
+constexpr Vec<U, N> operator-(Vec<U, N> const& v)
+{
+  return linalg_detail::map<U, N>([&](std::size_t i) {return -U(v.data()[i]);});
+}
+
+
+template <typename U1, typename U2, std::size_t N>
+constexpr auto operator+(Vec<U1, N> const& a, Vec<U2, N> const& b)
+{
+  return linalg_detail::map<linalg_detail::sum_t<U1, U2>, N>([&](std::size_t i) {return U1(a.data()[i]) + U2(b.data()[i]);});
+}
+
+
+template <typename U1, typename U2, std::size_t N>
+constexpr auto operator-(Vec<U1, N> const& a, Vec<U2, N> const& b)
+{
+  return linalg_detail::map<linalg_detail::sum_t<U1, U2>, N>([&](std::size_t i) {return U1(a.data()[i]) - U2(b.data()[i]);});
+}
+
+
+template <typename U, std::size_t N, typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+constexpr Vec<U, N> operator*(Vec<U, N> const& v, T const& coef)
+{
+  Vec<U, N> result(v);
+  return result *= coef;
+}
+
+
+template <typename T, typename U, std::size_t N, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+constexpr Vec<U, N> operator*(T const& coef, Vec<U, N> const& v)
+{
+  Vec<U, N> result(v);
+  return result *= coef;
+}
+
+
+template <typename U, std::size_t N, typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+constexpr Vec<U, N> operator/(Vec<U, N> const& v, T const& coef)
+{
+  Vec<U, N> result(v);
+  return result /= coef;
+}
+
+
+template <typename U1, std::size_t N, typename Dimension, typename Rep, typename Period, double const& Origin>
+constexpr auto operator*(Vec<U1, N> const& v, Unit<Dimension, Rep, Period, Origin> const& coef)
+{
+  typedef Unit<Dimension, Rep, Period, Origin> U2;
+  return linalg_detail::map<linalg_detail::product_t<U1, U2>, N>([&](std::size_t i) {return U1(v.data()[i]) * coef;});
+}
+
+
+template <typename Dimension, typename Rep, typename Period, double const& Origin, typename U2, std::size_t N>
+constexpr auto operator*(Unit<Dimension, Rep, Period, Origin> const& coef, Vec<U2, N> const& v)
+{
+  typedef Unit<Dimension, Rep, Period, Origin> U1;
+  return linalg_detail::map<linalg_detail::product_t<U1, U2>, N>([&](std::size_t i) {return coef * U2(v.data()[i]);});
+}
+
+
+template <typename U1, std::size_t N, typename Dimension, typename Rep, typename Period, double const& Origin>
+constexpr auto operator/(Vec<U1, N> const& v, Unit<Dimension, Rep, Period, Origin> const& coef)
+{
+  typedef Unit<Dimension, Rep, Period, Origin> U2;
+  return linalg_detail::map<linalg_detail::quotient_t<U1, U2>, N>([&](std::size_t i) {return U1(v.data()[i]) / coef;});
+}
+
+
+template <typename U1, typename U2, std::size_t N>
+constexpr bool operator==(Vec<U1, N> const& a, Vec<U2, N> const& b)
+{
+  for(std::size_t i = 0; i < N; i++)
+    if(!(a[i] == b[i]))
+      return false;
+  return true;
+}
+
+
+template <typename U1, typename U2, std::size_t N>
+constexpr bool operator!=(Vec<U1, N> const& a, Vec<U2, N> const& b)
+{
+  return !(a == b);
+}
+
+
+//dot(Vec3<meter<>>, Vec3<newton<>>) is in joules
+template <typename U1, typename U2, std::size_t N>
+constexpr auto dot(Vec<U1, N> const& a, Vec<U2, N> const& b)
+{
+  typedef linalg_detail::product_t<U1, U2> result;
+  typename result::rep sum = 0;
+  for(std::size_t i = 0; i < N; i++)
+    sum += (a[i] * b[i]).count();
+  return result(sum);
+}
+
+
+template <typename U1, typename U2>
+constexpr auto cross(Vec<U1, 3> const& a, Vec<U2, 3> const& b)
+{
+  return Vec<linalg_detail::product_t<U1, U2>, 3>(a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]);
+}
+
+
+template <typename U, std::size_t N>
+constexpr auto squared_norm(Vec<U, N> const& v)
+{
+  return dot(v, v);
+}
+
+
+//in the unit of the components
+template <typename U, std::size_t N>
+constexpr U norm(Vec<U, N> const& v)
+{
+  return U(sqrt(dot(v, v)));
+}
+
+
+template <typename left_operande_t, typename U, std::size_t N>
+left_operande_t& operator<<(left_operande_t& left_operande, Vec<U, N> const& v)
+{
+  left_operande << "(";
+  for(std::size_t i = 0; i < N; i++)
+    left_operande << (i == 0 ? "" : ", ") << v[i];
+  left_operande << ")";
+  return left_operande;
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== MATRICES ================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <typename U, std::size_t Rows, std::size_t Cols>
+class Mat
+{
+  static_assert(is_Unit<U>::value, "Components of a Mat should be units.");
+  static_assert(Rows > 0 && Cols > 0, "A Mat cannot be empty.");
+
+public:
+  typedef U unit;
+  typedef typename U::rep rep;
+  typedef Vec<U, Rows> column_type;
+
+
+  //null matrix
+  constexpr Mat():
+  _columns()
+  {
+  }
+
+
+  //components given row after row : Mat2<value<>>(value<>(1), value<>(2), value<>(3), value<>(4)) is [[1, 2], [3, 4]]
+  template <typename... Units, typename = typename std::enable_if<(sizeof...(Units) == Rows * Cols && (is_Unit<Units>::value && ...))>::type>
+  constexpr Mat(Units const&... components):
+  _columns()
+  {
+    U const values[] = {U(components)...};
+    for(std::size_t r = 0; r < Rows; r++)
+      for(std::size_t c = 0; c < Cols; c++)
+        _columns[c].set(r, values[r * Cols + c]);
+  }
+
+
+  //U(1) on the diagonal
+  static constexpr Mat identity()
+  {
+    Mat result;
+    for(std::size_t i = 0; i < Rows && i < Cols; i++)
+      result._columns[i].set(i, U(1));
+    return result;
+  }
+
+
+  static constexpr std::size_t rows()
+  {
+    return Rows;
+  }
+
+
+  static constexpr std::size_t cols()
+  {
+    return Cols;
+  }
+
+
+  constexpr U operator()(std::size_t row, std::size_t col) const
+  {
+    return _columns[col][row];
+  }
+
+
+  constexpr void set(std::size_t row, std::size_t col, U const& value)
+  {
+    _columns[col].set(row, value);
+  }
+
+
+  constexpr column_type const& col(std::size_t col) const
+  {
+    return _columns[col];
+  }
+
+
+  constexpr column_type& col(std::size_t col)
+  {
+    return _columns[col];
+  }
+
+
+  constexpr Vec<U, Cols> row(std::size_t row) const
+  {
+    Vec<U, Cols> result;
+    for(std::size_t c = 0; c < Cols; c++)
+      result.set(c, _columns[c][row]);
+    return result;
+  }
+
+
+  constexpr Mat<U, Cols, Rows> transpose() const
+  {
+    Mat<U, Cols, Rows> result;
+    for(std::size_t r = 0; r < Rows; r++)
+      result.col(r) = row(r);
+    return result;
+  }
+
+
+  template <typename U2>
+  constexpr Mat& operator+=(Mat<U2, Rows, Cols> const& other)
+  {
+    for(std::size_t c = 0; c < Cols; c++)
+      _columns[c] += other.col(c);
+    return *this;
+  }
+
+
+  template <typename U2>
+  constexpr Mat& operator-=(Mat<U2, Rows, Cols> const& other)
+  {
+    for(std::size_t c = 0; c < Cols; c++)
+      _columns[c] -= other.col(c);
+    return *this;
+  }
+
+
+  template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+  constexpr Mat& operator*=(T const& coef)
+  {
+    for(std::size_t c = 0; c < Cols; c++)
+      _columns[c] *= coef;
+    return *this;
+  }
+
+
+private:
+  column_type _columns[Cols];
+};
+
+
+template <typename U>
+using Mat2 = Mat<U, 2, 2>;
+
+template <typename U>
+using Mat3 = Mat<U, 3, 3>;
+
+template <typename U>
+using Mat4 = Mat<U, 4, 4>;
+
+
+template <typename falseType>
+struct is_Mat : std::false_type
+{
+};
+
+
+template <typename U, std::size_t Rows, std::size_t Cols>
+struct is_Mat<Mat<U, Rows, Cols>> : std::true_type
+{
+};
+
+
+template <typename U1, typename U2, std::size_t Rows, std::size_t Cols>
+constexpr auto operator+(Mat<U1, Rows, Cols> const& a, Mat<U2, Rows, Cols> const& b)
+{
+  Mat<linalg_detail::sum_t<U1, U2>, Rows, Cols> result;
+  for(std::size_t c = 0; c < Cols; c++)
+    result.col(c) = a.col(c) + b.col(c);
+  return result;
+}
+
+
+template <typename U1, typename U2, std::size_t Rows, std::size_t Cols>
+constexpr auto operator-(Mat<U1, Rows, Cols> const& a, Mat<U2, Rows, Cols> const& b)
+{
+  Mat<linalg_detail::sum_t<U1, U2>, Rows, Cols> result;
+  for(std::size_t c = 0; c < Cols; c++)
+    result.col(c) = a.col(c) - b.col(c);
+  return result;
+}
+
+
+template <typename U, std::size_t Rows, std::size_t Cols, typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+constexpr Mat<U, Rows, Cols> operator*(Mat<U, Rows, Cols> const& m, T const& coef)
+{
+  Mat<U, Rows, Cols> result(m);
+  return result *= coef;
+}
+
+
+template <typename T, typename U, std::size_t Rows, std::size_t Cols, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+constexpr Mat<U, Rows, Cols> operator*(T const& coef, Mat<U, Rows, Cols> const& m)
+{
+  Mat<U, Rows, Cols> result(m);
+  return result *= coef;
+}
+
+
+//sum of the columns weighted by the components of v : vertical operations only
+template <typename U1, typename U2, std::size_t Rows, std::size_t Cols>
+constexpr auto operator*(Mat<U1, Rows, Cols> const& m, Vec<U2, Cols> const& v)
+{
+  typedef linalg_detail::product_t<U1, U2> result;
+  typedef typename result::rep rep;
+  Vec<result, Rows> product;
+  for(std::size_t c = 0; c < Cols; c++)
+  {
+    U2 weight = v[c];
+    rep const* column = m.col(c).data();
+    for(std::size_t r = 0; r < Vec<result, Rows>::padded; r++)
+      product.data()[r] += (U1(column[r]) * weight).count();
+  }
+  return product;
+}
+
+
+template <typename U1, typename U2, std::size_t Rows, std::size_t Inner, std::size_t Cols>
+constexpr auto operator*(Mat<U1, Rows, Inner> const& a, Mat<U2, Inner, Cols> const& b)
+{
+  Mat<linalg_detail::product_t<U1, U2>, Rows, Cols> result;
+  for(std::size_t c = 0; c < Cols; c++)
+    result.col(c) = a * b.col(c);
+  return result;
+}
+
+
+template <typename U1, typename U2, std::size_t Rows, std::size_t Cols>
+constexpr bool operator==(Mat<U1, Rows, Cols> const& a, Mat<U2, Rows, Cols> const& b)
+{
+  for(std::size_t c = 0; c < Cols; c++)
+    if(a.col(c) != b.col(c))
+      return false;
+  return true;
+}
+
+
+template <typename U1, typename U2, std::size_t Rows, std::size_t Cols>
+constexpr bool operator!=(Mat<U1, Rows, Cols> const& a, Mat<U2, Rows, Cols> const& b)
+{
+  return !(a == b);
+}
+
+
+template <typename left_operande_t, typename U, std::size_t Rows, std::size_t Cols>
+left_operande_t& operator<<(left_operande_t& left_operande, Mat<U, Rows, Cols> const& m)
+{
+  left_operande << "(";
+  for(std::size_t r = 0; r < Rows; r++)
+    left_operande << (r == 0 ? "" : ", ") << m.row(r);
+  left_operande << ")";
+  return left_operande;
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== ARRAYS OF VECTORS =======================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//structure of arrays : component k of vector i is component(k)[i]
+template <typename U, std::size_t N>
+class VecArray
+{
+  static_assert(is_Unit<U>::value, "Components of a VecArray should be units.");
+
+public:
+  typedef U unit;
+  typedef typename U::rep rep;
+
+
+  VecArray():
+  _components()
+  {
+  }
+
+
+  explicit VecArray(std::size_t size):
+  _components()
+  {
+    resize(size);
+  }
+
+
+  std::size_t size() const
+  {
+    return _components[0].size();
+  }
+
+
+  void resize(std::size_t size)
+  {
+    for(std::size_t k = 0; k < N; k++)
+      _components[k].resize(size);
+  }
+
+
+  Vec<U, N> operator[](std::size_t i) const
+  {
+    Vec<U, N> result;
+    for(std::size_t k = 0; k < N; k++)
+      result.data()[k] = _components[k][i];
+    return result;
+  }
+
+
+  void set(std::size_t i, Vec<U, N> const& v)
+  {
+    for(std::size_t k = 0; k < N; k++)
+      _components[k][i] = v.data()[k];
+  }
+
+
+  void push_back(Vec<U, N> const& v)
+  {
+    for(std::size_t k = 0; k < N; k++)
+      _components[k].push_back(v.data()[k]);
+  }
+
+
+  //counts of a component
+  rep* component(std::size_t k)
+  {
+    return _components[k].data();
+  }
+
+
+  rep const* component(std::size_t k) const
+  {
+    return _components[k].data();
+  }
+
+
+private:
+  std::vector<rep> _components[N];
+};
+
+
+
+namespace batch
+{
+
+
+//out[i] = dot(a[i], b[i])
+template <typename U1, typename U2, std::size_t N, typename OutUnit>
+void dot(VecArray<U1, N> const& a, VecArray<U2, N> const& b, OutUnit* out)
+{
+  typedef linalg_detail::product_t<U1, U2> result;
+  typedef typename result::rep rep;
+
+  if(a.size() != b.size())
+    throw std::length_error("omni::batch : arrays have different sizes.");
+
+  typename U1::rep const* x[N];
+  typename U2::rep const* y[N];
+  for(std::size_t k = 0; k < N; k++)
+  {
+    x[k] = a.component(k);
+    y[k] = b.component(k);
+  }
+  for(std::size_t i = 0; i < a.size(); i++)
+  {
+    rep sum = 0;
+    for(std::size_t k = 0; k < N; k++)
+      sum += (U1(x[k][i]) * U2(y[k][i])).count();
+    out[i] = OutUnit(result(sum));
+  }
+}
+
+
+//out[i] = norm(a[i])
+template <typename U, std::size_t N, typename OutUnit>
+void norm(VecArray<U, N> const& a, OutUnit* out)
+{
+  typedef linalg_detail::product_t<U, U> square;
+  typedef typename square::rep rep;
+
+  typename U::rep const* x[N];
+  for(std::size_t k = 0; k < N; k++)
+    x[k] = a.component(k);
+  for(std::size_t i = 0; i < a.size(); i++)
+  {
+    rep sum = 0;
+    for(std::size_t k = 0; k < N; k++)
+      sum += (U(x[k][i]) * U(x[k][i])).count();
+    out[i] = OutUnit(U(sqrt(square(sum))));
+  }
+}
+
+
+//out[i] = cross(a[i], b[i]) ; out is resized
+template <typename U1, typename U2, typename OutUnit>
+void cross(VecArray<U1, 3> const& a, VecArray<U2, 3> const& b, VecArray<OutUnit, 3>& out)
+{
+  typedef linalg_detail::product_t<U1, U2> result;
+
+  if(a.size() != b.size())
+    throw std::length_error("omni::batch : arrays have different sizes.");
+  out.resize(a.size());
+
+  typename U1::rep const* x[3] = {a.component(0), a.component(1), a.component(2)};
+  typename U2::rep const* y[3] = {b.component(0), b.component(1), b.component(2)};
+  for(std::size_t k = 0; k < 3; k++)
+  {
+    std::size_t k1 = (k + 1) % 3;
+    std::size_t k2 = (k + 2) % 3;
+    typename OutUnit::rep* z = out.component(k);
+    for(std::size_t i = 0; i < a.size(); i++)
+      z[i] = OutUnit(result((U1(x[k1][i]) * U2(y[k2][i])).count() - (U1(x[k2][i]) * U2(y[k1][i])).count())).count();
+  }
+}
+
+
+//out[i] = m * v[i] ; out is resized
+template <typename U1, typename U2, std::size_t Rows, std::size_t Cols, typename OutUnit>
+void transform(Mat<U1, Rows, Cols> const& m, VecArray<U2, Cols> const& v, VecArray<OutUnit, Rows>& out)
+{
+  typedef linalg_detail::product_t<U1, U2> result;
+  typedef typename result::rep rep;
+
+  out.resize(v.size());
+  for(std::size_t r = 0; r < Rows; r++)
+  {
+    U1 coef[Cols];
+    typename U2::rep const* x[Cols];
+    for(std::size_t c = 0; c < Cols; c++)
+    {
+      coef[c] = m(r, c);
+      x[c] = v.component(c);
+    }
+    typename OutUnit::rep* z = out.component(r);
+    for(std::size_t i = 0; i < v.size(); i++)
+    {
+      rep sum = 0;
+      for(std::size_t c = 0; c < Cols; c++)
+        sum += (coef[c] * U2(x[c][i])).count();
+      z[i] = OutUnit(result(sum)).count();
+    }
+  }
+}
+
+
+template <typename U1, typename U2, std::size_t N, typename OutContainer>
+auto dot(VecArray<U1, N> const& a, VecArray<U2, N> const& b, OutContainer& out) -> decltype(out.data(), void())
+{
+  if(out.size() < a.size())
+    throw std::length_error("omni::batch : output is smaller than input.");
+  dot(a, b, out.data());
+}
+
+
+template <typename U, std::size_t N, typename OutContainer>
+auto norm(VecArray<U, N> const& a, OutContainer& out) -> decltype(out.data(), void())
+{
+  if(out.size() < a.size())
+    throw std::length_error("omni::batch : output is smaller than input.");
+  norm(a, out.data());
+}
+
+
+} //namespace batch
+
+
+
+} //namespace omni
+
+
+
+#endif //OMNIUNIT_LINALG_HH_
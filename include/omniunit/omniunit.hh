@@ -39,20 +39,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "settings.hh"
 
-#if OMNI_USE_SAME_TYPE_FOR_UNCERTAINTIES
-  #define OMNI_UTYPE Rep
-  #define OMNI_UTYPE1 Rep1
-  #define OMNI_UTYPE2 Rep2
-  #define OMNI_UTYPE_ _Rep
-  #define OMNI_UTYPE_COMMON common
-#else
-  #define OMNI_UTYPE OMNI_DEFAULT_UNCERTAINTY_TYPE
-  #define OMNI_UTYPE1 OMNI_DEFAULT_UNCERTAINTY_TYPE
-  #define OMNI_UTYPE2 OMNI_DEFAULT_UNCERTAINTY_TYPE
-  #define OMNI_UTYPE_ OMNI_DEFAULT_UNCERTAINTY_TYPE
-  #define OMNI_UTYPE_COMMON OMNI_DEFAULT_UNCERTAINTY_TYPE
-#endif //OMNI_USE_SAME_TYPE_FOR_UNCERTAINTIES
-
 #include "core/Unit.hh"
 
 
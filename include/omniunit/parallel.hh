@@ -0,0 +1,314 @@
+//parallel.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_PARALLEL_HH_
+#define OMNIUNIT_PARALLEL_HH_
+
+// omni::parallel::for_each, transform, reduce and transform_reduce run loops over
+// arrays of units (pointer and size, or containers with data() and size()) on a
+// work-stealing ThreadPool. The element types are those of the arrays and of the
+// operations, so the dimensions are checked at compile time as in scalar code.
+//
+// ranges are cut in chunks whose elements fill half of OMNI_L2_CACHE_SIZE (see
+// settings.hh). Each thread of the pool first takes the chunks of its own contiguous
+// slice of the range, then steals chunks from the end of the slices of the others.
+// A pool built with pinned = true binds its threads to cores (Linux only) : a range
+// first written by a parallel loop is then read again by the cores of its memory
+// node, which keeps the placement of the pages on NUMA machines.
+//
+// reduce and transform_reduce fold blocks of 64 elements and combine them along a
+// pairwise tree, in order : the chunks only depend on the element types, so the result is the same
+// for any number of threads.
+//
+// the last parameter is the pool, ThreadPool::instance() by default (one thread per
+// hardware thread, the calling thread included). Loops started from a task of a pool
+// run on the calling thread. An exception thrown by an operation is rethrown by the
+// algorithm, once the running chunks are done.
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "core/Unit.hh"
+#include "core/kernels.hh"
+#include "thread_pool.hh"
+
+
+
+namespace omni
+{
+namespace parallel
+{
+
+
+
+namespace parallel_detail
+{
+
+
+//chunks never get smaller than this, whatever the size of the elements
+inline constexpr std::size_t minimumChunk = 1024;
+
+
+//elements of the given types filling half of the L2 cache
+template <typename... T>
+constexpr std::size_t chunk_size()
+{
+  std::size_t bytes = (sizeof(T) + ... + 0);
+  return std::max(minimumChunk, static_cast<std::size_t>(OMNI_L2_CACHE_SIZE) / 2 / std::max<std::size_t>(bytes, 1));
+}
+
+
+//chunk(start, count) for the chunks of [0, size), run by pool
+template <typename Chunk>
+void chunks(std::size_t size, std::size_t chunkSize, ThreadPool& pool, Chunk const& chunk)
+{
+  std::size_t number = (size + chunkSize - 1) / chunkSize;
+  pool.run(number, [&](std::size_t k)
+  {
+    chunk(k * chunkSize, std::min(chunkSize, size - k * chunkSize));
+  });
+}
+
+
+//results of chunk(start, count) for the chunks of [0, size), combined in order by op
+template <typename T, typename Chunk, typename BinaryOp>
+T combine(std::size_t size, std::size_t chunkSize, ThreadPool& pool, T init, Chunk const& chunk, BinaryOp const& op)
+{
+  if(size == 0)
+    return init;
+  std::size_t number = (size + chunkSize - 1) / chunkSize;
+  std::vector<std::unique_ptr<T>> partial(number);
+  chunks(size, chunkSize, pool, [&](std::size_t start, std::size_t count)
+  {
+    partial[start / chunkSize] = std::make_unique<T>(chunk(start, count));
+  });
+  return op(init, kernel_detail::tree<T>(0, number, [&](std::size_t k) -> T const& {return *partial[k];}, op));
+}
+
+
+//op over a pairwise tree of blocks of at most kernel_detail::pairwiseBlock elements,
+//each one folded on interleaved lanes
+template <typename T, typename Load, typename BinaryOp>
+T fold(std::size_t start, std::size_t size, Load const& load, BinaryOp const& op)
+{
+  constexpr std::size_t lanes = kernel_detail::lanes;
+  static_assert(lanes == 8, "A block is folded on 8 lanes.");
+  if(size > kernel_detail::pairwiseBlock)
+  {
+    std::size_t half = size / 2;
+    return op(fold<T>(start, half, load, op), fold<T>(start + half, size - half, load, op));
+  }
+  if(size < 2 * lanes)
+  {
+    T result(load(start));
+    for(std::size_t i = start + 1; i < start + size; i++)
+      result = op(result, load(i));
+    return result;
+  }
+
+  T partial[lanes] = {T(load(start)), T(load(start + 1)), T(load(start + 2)), T(load(start + 3)),
+                      T(load(start + 4)), T(load(start + 5)), T(load(start + 6)), T(load(start + 7))};
+  std::size_t i = start + lanes;
+  for(; i + lanes <= start + size; i += lanes)
+    for(std::size_t l = 0; l < lanes; l++)
+      partial[l] = op(partial[l], load(i + l));
+  for(std::size_t l = 0; i < start + size; i++, l++)
+    partial[l] = op(partial[l], load(i));
+  return op(op(op(partial[0], partial[1]), op(partial[2], partial[3])), op(op(partial[4], partial[5]), op(partial[6], partial[7])));
+}
+
+
+template <typename Container1, typename Container2>
+void check_sizes(Container1 const& first, Container2 const& second, char const* message)
+{
+  if(first.size() != second.size())
+    throw std::length_error(message);
+}
+
+
+} //namespace parallel_detail
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== ALGORITHMS ==============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//f(values[i]) for every element
+template <typename T, typename Function>
+void for_each(T* values, std::size_t size, Function f, ThreadPool& pool = ThreadPool::instance())
+{
+  parallel_detail::chunks(size, parallel_detail::chunk_size<T>(), pool, [&](std::size_t start, std::size_t count)
+  {
+    for(std::size_t i = start; i < start + count; i++)
+      f(values[i]);
+  });
+}
+
+
+//out[i] = op(in[i])
+template <typename In, typename Out, typename UnaryOp>
+void transform(In const* in, std::size_t size, Out* out, UnaryOp op, ThreadPool& pool = ThreadPool::instance())
+{
+  parallel_detail::chunks(size, parallel_detail::chunk_size<In, Out>(), pool, [&](std::size_t start, std::size_t count)
+  {
+    for(std::size_t i = start; i < start + count; i++)
+      out[i] = op(in[i]);
+  });
+}
+
+
+//out[i] = op(in1[i], in2[i])
+template <typename In1, typename In2, typename Out, typename BinaryOp>
+void transform(In1 const* in1, In2 const* in2, std::size_t size, Out* out, BinaryOp op, ThreadPool& pool = ThreadPool::instance())
+{
+  parallel_detail::chunks(size, parallel_detail::chunk_size<In1, In2, Out>(), pool, [&](std::size_t start, std::size_t count)
+  {
+    for(std::size_t i = start; i < start + count; i++)
+      out[i] = op(in1[i], in2[i]);
+  });
+}
+
+
+//op(init, op(op(v0, v1), op(v2, v3))...) : op should be associative
+template <typename Value, typename T, typename BinaryOp>
+T reduce(Value const* values, std::size_t size, T init, BinaryOp op, ThreadPool& pool = ThreadPool::instance())
+{
+  return parallel_detail::combine<T>(size, parallel_detail::chunk_size<Value>(), pool, init, [&](std::size_t start, std::size_t count)
+  {
+    return parallel_detail::fold<T>(start, count, [&](std::size_t i) -> Value const& {return values[i];}, op);
+  }, op);
+}
+
+
+//reduce of transform(values[i])
+template <typename Value, typename T, typename BinaryOp, typename UnaryOp>
+T transform_reduce(Value const* values, std::size_t size, T init, BinaryOp reduceOp, UnaryOp transformOp, ThreadPool& pool = ThreadPool::instance())
+{
+  return parallel_detail::combine<T>(size, parallel_detail::chunk_size<Value>(), pool, init, [&](std::size_t start, std::size_t count)
+  {
+    return parallel_detail::fold<T>(start, count, [&](std::size_t i) {return transformOp(values[i]);}, reduceOp);
+  }, reduceOp);
+}
+
+
+//reduce of transform(values1[i], values2[i]) : an inner product with std::plus<>() and std::multiplies<>()
+template <typename Value1, typename Value2, typename T, typename BinaryOp, typename BinaryTransformOp>
+T transform_reduce(Value1 const* values1, Value2 const* values2, std::size_t size, T init, BinaryOp reduceOp, BinaryTransformOp transformOp,
+                   ThreadPool& pool = ThreadPool::instance())
+{
+  return parallel_detail::combine<T>(size, parallel_detail::chunk_size<Value1, Value2>(), pool, init, [&](std::size_t start, std::size_t count)
+  {
+    return parallel_detail::fold<T>(start, count, [&](std::size_t i) {return transformOp(values1[i], values2[i]);}, reduceOp);
+  }, reduceOp);
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== CONTAINERS ==============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <typename Container, typename Function>
+auto for_each(Container& values, Function f, ThreadPool& pool = ThreadPool::instance()) -> decltype(parallel::for_each(values.data(), values.size(), f, pool))
+{
+  parallel::for_each(values.data(), values.size(), f, pool);
+}
+
+
+template <typename ContainerIn, typename ContainerOut, typename UnaryOp>
+auto transform(ContainerIn const& in, ContainerOut& out, UnaryOp op, ThreadPool& pool = ThreadPool::instance())
+-> decltype(parallel::transform(in.data(), in.size(), out.data(), op, pool))
+{
+  parallel_detail::check_sizes(in, out, "omni::parallel::transform : the output container size differs from the input one");
+  parallel::transform(in.data(), in.size(), out.data(), op, pool);
+}
+
+
+template <typename ContainerIn1, typename ContainerIn2, typename ContainerOut, typename BinaryOp>
+auto transform(ContainerIn1 const& in1, ContainerIn2 const& in2, ContainerOut& out, BinaryOp op, ThreadPool& pool = ThreadPool::instance())
+-> decltype(parallel::transform(in1.data(), in2.data(), in1.size(), out.data(), op, pool))
+{
+  parallel_detail::check_sizes(in1, in2, "omni::parallel::transform : the input containers do not have the same size");
+  parallel_detail::check_sizes(in1, out, "omni::parallel::transform : the output container size differs from the input ones");
+  parallel::transform(in1.data(), in2.data(), in1.size(), out.data(), op, pool);
+}
+
+
+template <typename Container, typename T, typename BinaryOp>
+auto reduce(Container const& values, T init, BinaryOp op, ThreadPool& pool = ThreadPool::instance())
+-> decltype(parallel::reduce(values.data(), values.size(), init, op, pool))
+{
+  return parallel::reduce(values.data(), values.size(), init, op, pool);
+}
+
+
+template <typename Container, typename T, typename BinaryOp, typename UnaryOp>
+auto transform_reduce(Container const& values, T init, BinaryOp reduceOp, UnaryOp transformOp, ThreadPool& pool = ThreadPool::instance())
+-> decltype(parallel::transform_reduce(values.data(), values.size(), init, reduceOp, transformOp, pool))
+{
+  return parallel::transform_reduce(values.data(), values.size(), init, reduceOp, transformOp, pool);
+}
+
+
+template <typename Container1, typename Container2, typename T, typename BinaryOp, typename BinaryTransformOp>
+auto transform_reduce(Container1 const& values1, Container2 const& values2, T init, BinaryOp reduceOp, BinaryTransformOp transformOp,
+                      ThreadPool& pool = ThreadPool::instance())
+-> decltype(parallel::transform_reduce(values1.data(), values2.data(), values1.size(), init, reduceOp, transformOp, pool))
+{
+  parallel_detail::check_sizes(values1, values2, "omni::parallel::transform_reduce : the containers do not have the same size");
+  return parallel::transform_reduce(values1.data(), values2.data(), values1.size(), init, reduceOp, transformOp, pool);
+}
+
+
+
+} //namespace parallel
+} //namespace omni
+
+#endif //OMNIUNIT_PARALLEL_HH_
@@ -0,0 +1,322 @@
+//queue.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_QUEUE_HH_
+#define OMNIUNIT_QUEUE_HH_
+
+// omni::spsc_queue<U, Time> and omni::mpsc_queue<U, Time> are bounded lock-free queues
+// of samples (a time and a value) between one or several producers and one consumer.
+// Producers push in their own units (U and Time), which are stored as raw counts, so
+// that pushing costs no conversion. The consumer pops in batches into arrays of any
+// units of the same dimensions : the counts are converted in bulk, along contiguous
+// ranges of the ring, with the constants of the conversion (see Conversion in
+// core/Unit.hh), which the compiler vectorizes for floating point Reps.
+//
+//   omni::mpsc_queue<omni::millibar<float>> queue(1 << 16);
+//   queue.push(omni::nanosecond<std::int64_t>(now), omni::millibar<float>(1013.25f));   //producers
+//   std::size_t count = queue.pop(times, pascals, 4096);                             //consumer
+//
+// the capacity is rounded up to a power of two. push returns false (or the number of
+// samples pushed, for arrays) when the queue is full, and pop returns the number of
+// samples popped, 0 when the queue is empty. The times of pop may be nullptr.
+// Producers of an mpsc_queue claim their cells with a compare-exchange, and publish
+// them one by one : the consumer only pops the samples published in order.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "core/Unit.hh"
+#include "core/kernels.hh"
+#include "units/duration.hh"
+
+
+
+namespace omni
+{
+
+
+enum class Producers
+{
+  Single,
+  Multiple
+};
+
+
+template <typename U, typename Time = nanosecond<std::int64_t>>
+struct sample
+{
+  Time time{};
+  U value{};
+};
+
+
+
+namespace queue_detail
+{
+
+
+inline std::size_t round_capacity(std::size_t capacity)
+{
+  std::size_t rounded = 1;
+  while(rounded < capacity)
+    rounded <<= 1;
+  return rounded;
+}
+
+
+//out[i] = counts[i] of From, converted to To
+template <typename From, typename To>
+void convert(typename From::rep const* counts, std::size_t size, To* out)
+{
+  static_assert(std::is_same<typename From::dim, typename To::dim>::value, "Cannot pop samples into a different dimension.");
+  typedef typename std::common_type<typename To::rep, typename From::rep>::type common;
+  typedef Conversion<From, To> conv;
+
+  for(std::size_t i = 0; i < size; i++)
+    out[i] = To(convert_count<typename To::rep, common>(static_cast<common>(counts[i]), conv::num, conv::den, conv::offset));
+}
+
+
+} //namespace queue_detail
+
+
+
+template <typename U, typename Time = nanosecond<std::int64_t>, Producers producers = Producers::Single>
+class sample_queue
+{
+  static_assert(is_Unit<U>::value, "Samples hold an omni::Unit.");
+  static_assert(is_Unit<Time>::value && std::is_same<typename Time::dim, Dimension<0,0,1,0,0,0,0>>::value, "The time of samples should be a duration.");
+
+  typedef typename U::rep rep;
+  typedef typename Time::rep time_rep;
+
+  public:
+
+  typedef U value_type;
+  typedef Time time_type;
+
+
+  explicit sample_queue(std::size_t capacity):
+  _mask(queue_detail::round_capacity(std::max<std::size_t>(capacity, 1)) - 1),
+  _times(new time_rep[_mask + 1]), _values(new rep[_mask + 1]),
+  _published(producers == Producers::Multiple ? new std::atomic<std::size_t>[_mask + 1] : nullptr),
+  _tail(0), _cachedHead(0), _head(0), _cachedTail(0)
+  {
+    if constexpr(producers == Producers::Multiple)
+    {
+      //no cell is published for the first lap
+      for(std::size_t i = 0; i <= _mask; i++)
+        _published[i].store(i - 1, std::memory_order_relaxed);
+    }
+  }
+
+  sample_queue(sample_queue const&) = delete;
+  sample_queue& operator=(sample_queue const&) = delete;
+
+
+  std::size_t capacity() const
+  {
+    return _mask + 1;
+  }
+
+  //samples pushed and not popped yet : exact only when producers and consumer are idle
+  std::size_t size() const
+  {
+    return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+  }
+
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+
+  bool push(Time const& time, U const& value)
+  {
+    return push(&time, &value, 1) == 1;
+  }
+
+
+  //pushes the first samples that fit, and returns their number
+  std::size_t push(Time const* times, U const* values, std::size_t count)
+  {
+    std::size_t position = 0;
+    std::size_t claimed = claim(count, position);
+    for(std::size_t i = 0; i < claimed; i++)
+    {
+      std::size_t cell = (position + i) & _mask;
+      _times[cell] = times[i].count();
+      _values[cell] = values[i].count();
+    }
+    publish(position, claimed);
+    return claimed;
+  }
+
+
+  //pops at most max samples, converted to the units of times and values, and returns their number
+  template <typename CTime, typename C>
+  std::size_t pop(CTime* times, C* values, std::size_t max)
+  {
+    static_assert(is_Unit<C>::value && is_Unit<CTime>::value, "Samples are popped into omni::Unit.");
+
+    std::size_t head = _head.load(std::memory_order_relaxed);
+    std::size_t count = available(head, max);
+    std::size_t first = std::min(count, capacity() - (head & _mask));
+    std::size_t segments[2][3] = {{head & _mask, 0, first}, {0, first, count - first}};
+    for(auto const& segment : segments)
+    {
+      if(segment[2] == 0)
+        continue;
+      if(times != nullptr)
+        queue_detail::convert<Time>(_times.get() + segment[0], segment[2], times + segment[1]);
+      queue_detail::convert<U>(_values.get() + segment[0], segment[2], values + segment[1]);
+    }
+    _head.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+
+  template <typename CTime, typename C>
+  bool pop(sample<C, CTime>& out)
+  {
+    CTime time;
+    C value;
+    if(pop(&time, &value, 1) == 0)
+      return false;
+    out.time = time;
+    out.value = value;
+    return true;
+  }
+
+
+  template <typename TimeContainer, typename ValueContainer>
+  auto pop(TimeContainer& times, ValueContainer& values) -> decltype(pop(times.data(), values.data(), values.size()))
+  {
+    if(times.size() != values.size())
+      throw std::length_error("omni::sample_queue::pop : the time and value containers do not have the same size");
+    return pop(times.data(), values.data(), values.size());
+  }
+
+
+  private:
+
+  //claims at most count cells, starting at position, and returns their number
+  std::size_t claim(std::size_t count, std::size_t& position)
+  {
+    if constexpr(producers == Producers::Single)
+    {
+      position = _tail.load(std::memory_order_relaxed);
+      if(capacity() - (position - _cachedHead) < count)
+        _cachedHead = _head.load(std::memory_order_acquire);
+      return std::min(count, capacity() - (position - _cachedHead));
+    }
+    else
+    {
+      position = _tail.load(std::memory_order_relaxed);
+      while(true)
+      {
+        std::size_t claimed = std::min(count, capacity() - (position - _head.load(std::memory_order_acquire)));
+        if(claimed == 0)
+          return 0;
+        if(_tail.compare_exchange_weak(position, position + claimed, std::memory_order_relaxed, std::memory_order_relaxed))
+          return claimed;
+      }
+    }
+  }
+
+
+  void publish(std::size_t position, std::size_t count)
+  {
+    if constexpr(producers == Producers::Single)
+    {
+      _tail.store(position + count, std::memory_order_release);
+    }
+    else
+    {
+      for(std::size_t i = 0; i < count; i++)
+        _published[(position + i) & _mask].store(position + i, std::memory_order_release);
+    }
+  }
+
+
+  //samples ready to be popped from head, at most max
+  std::size_t available(std::size_t head, std::size_t max)
+  {
+    if constexpr(producers == Producers::Single)
+    {
+      if(_cachedTail - head < max)
+        _cachedTail = _tail.load(std::memory_order_acquire);
+      return std::min(max, _cachedTail - head);
+    }
+    else
+    {
+      std::size_t count = 0;
+      while(count < max && _published[(head + count) & _mask].load(std::memory_order_acquire) == head + count)
+        count++;
+      return count;
+    }
+  }
+
+
+  std::size_t const _mask;
+  std::unique_ptr<time_rep[]> const _times;
+  std::unique_ptr<rep[]> const _values;
+  std::unique_ptr<std::atomic<std::size_t>[]> const _published;
+
+  //written by the producers
+  alignas(kernel_detail::cacheLine) std::atomic<std::size_t> _tail;
+  std::size_t _cachedHead;
+
+  //written by the consumer
+  alignas(kernel_detail::cacheLine) std::atomic<std::size_t> _head;
+  std::size_t _cachedTail;
+};
+
+
+template <typename U, typename Time = nanosecond<std::int64_t>>
+using spsc_queue = sample_queue<U, Time, Producers::Single>;
+
+template <typename U, typename Time = nanosecond<std::int64_t>>
+using mpsc_queue = sample_queue<U, Time, Producers::Multiple>;
+
+
+
+} //namespace omni
+
+#endif //OMNIUNIT_QUEUE_HH_
@@ -0,0 +1,304 @@
+//reduce.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_REDUCE_HH_
+#define OMNIUNIT_REDUCE_HH_
+
+// omni::sum(units, size) adds arrays of units on their counts, without the conversions
+// and uncertainty branches of operator+=, following a Summation strategy :
+//
+//   Naive      one running sum
+//   Neumaier   8 running sums compensated like in Neumaier's variant of Kahan's
+//              algorithm : the error does not grow with the size (default)
+//   Pairwise   halves the range down to blocks of 64 : the error grows like log(size)
+//   Blocked    8 independent running sums : fastest, the error grows like size / 8
+//
+// counts are added in double (long double for long double Reps), and the result is in
+// the unit of the elements, without uncertainty. Integer Reps (and omni::Integer) are
+// added exactly in their Rep, whatever the strategy.
+//
+// omni::reduce(units, size, init, op) reduces with any associative op, along a
+// pairwise tree (omni::parallel::reduce of parallel.hh runs it on a ThreadPool).
+//
+// sum splits the range in chunks of fixed size, and combines the results of the chunks
+// in order : the result is the same whether the chunks run on the calling thread, or on
+// the threads of an omni::parallel::ThreadPool given as last parameter.
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "core/Unit.hh"
+#include "core/kernels.hh"
+#include "thread_pool.hh"
+
+
+
+namespace omni
+{
+
+
+enum class Summation
+{
+  Naive,
+  Neumaier,
+  Pairwise,
+  Blocked
+};
+
+
+
+namespace reduce_detail
+{
+
+
+//unit of work of a thread : results do not depend on the number of threads
+inline constexpr std::size_t chunkSize = std::size_t(1) << 15;
+
+using kernel_detail::lanes;
+using kernel_detail::pairwiseBlock;
+
+
+template <typename acc, typename Load>
+acc naive(std::size_t size, Load const& load)
+{
+  acc sum = 0;
+  for(std::size_t i = 0; i < size; i++)
+    sum += load(i);
+  return sum;
+}
+
+
+//the rounding error of sum + x goes to compensation : Neumaier's compensation, computed
+//with Knuth's TwoSum which needs no comparison, so that the lanes vectorize
+template <typename acc>
+void neumaier_add(acc& sum, acc& compensation, acc x)
+{
+  acc t = sum + x;
+  acc z = t - sum;
+  compensation += (sum - (t - z)) + (x - z);
+  sum = t;
+}
+
+
+template <typename acc, typename Load>
+acc neumaier(std::size_t size, Load const& load)
+{
+  acc sum[lanes] = {};
+  acc compensation[lanes] = {};
+  std::size_t i = 0;
+  for(; i + lanes <= size; i += lanes)
+    for(std::size_t l = 0; l < lanes; l++)
+      neumaier_add(sum[l], compensation[l], load(i + l));
+  for(; i < size; i++)
+    neumaier_add(sum[0], compensation[0], load(i));
+
+  acc total = 0;
+  acc totalCompensation = 0;
+  for(std::size_t l = 0; l < lanes; l++)
+  {
+    neumaier_add(total, totalCompensation, sum[l]);
+    neumaier_add(total, totalCompensation, compensation[l]);
+  }
+  return total + totalCompensation;
+}
+
+
+//sum of load(i) for i in [start, start + size)
+template <typename acc, typename Load>
+acc pairwise(std::size_t start, std::size_t size, Load const& load)
+{
+  if(size <= pairwiseBlock)
+    return kernel_detail::lane_sum<acc>(size, [&](std::size_t i) {return load(start + i);});
+  std::size_t half = size / 2;
+  return pairwise<acc>(start, half, load) + pairwise<acc>(start + half, size - half, load);
+}
+
+
+template <typename acc, typename Load>
+acc sum(Summation strategy, std::size_t size, Load const& load)
+{
+  switch(strategy)
+  {
+    case Summation::Naive :
+      return naive<acc>(size, load);
+    case Summation::Pairwise :
+      return pairwise<acc>(0, size, load);
+    case Summation::Blocked :
+      return kernel_detail::lane_sum<acc>(size, load);
+    case Summation::Neumaier :
+    default :
+      return neumaier<acc>(size, load);
+  }
+}
+
+
+//results of chunk(start, count) for the chunks of [0, size), on the calling thread
+//if pool is null
+template <typename T, typename Chunk>
+std::vector<T> chunks(std::size_t size, parallel::ThreadPool* pool, Chunk const& chunk)
+{
+  std::size_t number = (size + chunkSize - 1) / chunkSize;
+  std::vector<T> results(number);
+  auto task = [&](std::size_t k)
+  {
+    results[k] = chunk(k * chunkSize, std::min(chunkSize, size - k * chunkSize));
+  };
+
+  if(pool == nullptr)
+    for(std::size_t k = 0; k < number; k++)
+      task(k);
+  else
+    pool->run(number, task);
+  return results;
+}
+
+
+template <typename _Dimension, typename Rep, typename Period, double const& Origin>
+Unit<_Dimension, Rep, Period, Origin> sum_units(Unit<_Dimension, Rep, Period, Origin> const* values, std::size_t size,
+                                                Summation strategy, parallel::ThreadPool* pool)
+{
+  typedef Unit<_Dimension, Rep, Period, Origin> unit;
+
+  if constexpr(is_integer_rep<Rep>::value)
+  {
+    std::vector<Rep> partial = chunks<Rep>(size, pool, [&](std::size_t start, std::size_t count)
+    {
+      Rep total(0);
+      for(std::size_t i = 0; i < count; i++)
+        total += values[start + i].count();
+      return total;
+    });
+    Rep total(0);
+    for(Rep const& count : partial)
+      total += count;
+    return unit(total);
+  }
+  else
+  {
+    typedef kernel_detail::accumulator_t<Rep> acc;
+    std::vector<acc> partial = chunks<acc>(size, pool, [&](std::size_t start, std::size_t count)
+    {
+      return sum<acc>(strategy, count, [&](std::size_t i) {return static_cast<acc>(values[start + i].count());});
+    });
+    return unit(static_cast<Rep>(sum<acc>(strategy, partial.size(), [&](std::size_t i) {return partial[i];})));
+  }
+}
+
+
+} //namespace reduce_detail
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== SUM =====================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <typename _Dimension, typename Rep, typename Period, double const& Origin>
+Unit<_Dimension, Rep, Period, Origin> sum(Unit<_Dimension, Rep, Period, Origin> const* values, std::size_t size,
+                                          Summation strategy = Summation::Neumaier)
+{
+  return reduce_detail::sum_units(values, size, strategy, nullptr);
+}
+
+
+//chunks run on the threads of pool
+template <typename _Dimension, typename Rep, typename Period, double const& Origin>
+Unit<_Dimension, Rep, Period, Origin> sum(Unit<_Dimension, Rep, Period, Origin> const* values, std::size_t size,
+                                          Summation strategy, parallel::ThreadPool& pool)
+{
+  return reduce_detail::sum_units(values, size, strategy, &pool);
+}
+
+
+template <typename Container>
+auto sum(Container const& values, Summation strategy = Summation::Neumaier) -> decltype(sum(values.data(), values.size(), strategy))
+{
+  return sum(values.data(), values.size(), strategy);
+}
+
+
+template <typename Container>
+auto sum(Container const& values, Summation strategy, parallel::ThreadPool& pool) -> decltype(sum(values.data(), values.size(), strategy, pool))
+{
+  return sum(values.data(), values.size(), strategy, pool);
+}
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== REDUCE ==================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//op(init, op(op(v0, v1), op(v2, v3))...) : op should be associative.
+//omni::parallel::reduce (see parallel.hh) runs the same reduction on a ThreadPool.
+template <typename Value, typename T, typename BinaryOp>
+T reduce(Value const* values, std::size_t size, T init, BinaryOp op)
+{
+  if(size == 0)
+    return init;
+  std::vector<T> partial = reduce_detail::chunks<T>(size, nullptr, [&](std::size_t start, std::size_t count)
+  {
+    return kernel_detail::tree<T>(start, count, [&](std::size_t i) -> Value const& {return values[i];}, op);
+  });
+  return op(init, kernel_detail::tree<T>(0, partial.size(), [&](std::size_t i) -> T const& {return partial[i];}, op));
+}
+
+
+template <typename Container, typename T, typename BinaryOp>
+auto reduce(Container const& values, T init, BinaryOp op) -> decltype(reduce(values.data(), values.size(), init, op))
+{
+  return reduce(values.data(), values.size(), init, op);
+}
+
+
+
+} //namespace omni
+
+
+
+#endif //OMNIUNIT_REDUCE_HH_
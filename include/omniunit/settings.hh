@@ -35,25 +35,38 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef OMNIUNIT_SETTINGS_HH_
 #define OMNIUNIT_SETTINGS_HH_
 
+// Every setting below can be overriden from the command line (-DOMNI_TRUE_ZERO=true...)
+// instead of editing this file. When OmniUnit is used as a module, the settings are
+// those given when building the module interfaces (see ./modules/ ) : they cannot
+// be changed by the importing translation units.
+
 // if OMNI_INCLUDE_ALL_UNITS is true, all predefined units are included with omniunit.
 // To decrease compilation time, OMNI_INCLUDE_ALL_UNITS should be set on false and
 // units should be included one by one according to what units are needed.
 // (See what files to include in ./include/omniunit/units/ ).
 // default : true
-#define OMNI_INCLUDE_ALL_UNITS true
+#ifndef OMNI_INCLUDE_ALL_UNITS
+  #define OMNI_INCLUDE_ALL_UNITS true
+#endif
 
 // OMNI_DEFAULT_TYPE is the default type internally handled by units
 // to represent the value (not the uncertainty) when they
 // are used with a capital (like Meter != meter).
 // default : double
-#define OMNI_DEFAULT_TYPE double
+#ifndef OMNI_DEFAULT_TYPE
+  #define OMNI_DEFAULT_TYPE double
+#endif
 
 // if OMNI_USE_SAME_TYPE_FOR_UNCERTAINTIES is true, the type internally
 // handled by units to represent the uncertainty is the same as the value type.
 // Othewise, OMNI_DEFAULT_UNCERTAINTY_TYPE is used.
 // default : true, double
-#define OMNI_USE_SAME_TYPE_FOR_UNCERTAINTIES true
-#define OMNI_DEFAULT_UNCERTAINTY_TYPE double
+#ifndef OMNI_USE_SAME_TYPE_FOR_UNCERTAINTIES
+  #define OMNI_USE_SAME_TYPE_FOR_UNCERTAINTIES true
+#endif
+#ifndef OMNI_DEFAULT_UNCERTAINTY_TYPE
+  #define OMNI_DEFAULT_UNCERTAINTY_TYPE double
+#endif
 
 // if OMNI_TRUE_ZERO is true, then the true zero of the unit is considered in calculations.
 // for example, if OMNI_TRUE_ZERO is :
@@ -61,15 +74,21 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // - false : 0 celsius * 10 = 2458.35 celsius (aka 2731.5 kelvin)
 // because 0C = 273.15K, and 273.15K multiplied by 10 equals 2731.5K = 2458.35C
 // default : false
-#define OMNI_TRUE_ZERO false
+#ifndef OMNI_TRUE_ZERO
+  #define OMNI_TRUE_ZERO false
+#endif
 
 // OMNI_LITTERAL_INTEGER and OMNI_LITTERAL_FLOATING are the type handled
 // by units returned by litteral operators, according to the operator overload used (integer or floating point).
 // the type returned by  5_m is meter<OMNI_LITTERAL_INTEGER>
 // the type returned by 5._m is meter<OMNI_LITTERAL_FLOATING>
 // default : int and double
-#define OMNI_LITTERAL_INTEGER int
-#define OMNI_LITTERAL_FLOATING double
+#ifndef OMNI_LITTERAL_INTEGER
+  #define OMNI_LITTERAL_INTEGER int
+#endif
+#ifndef OMNI_LITTERAL_FLOATING
+  #define OMNI_LITTERAL_FLOATING double
+#endif
 
 // if OMNI_USE_STD_EPSILON equals true, all INTERNAL comparisons between floating points are
 // done according to default epsilon (FLT_EPSILON, DBL_EPSILON...). Else, INTERNAL comparisons are done with
@@ -77,31 +96,79 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // comparisons internally needed, like in Ratio and Dimension operations).
 // OMNI_USE_STD_EPSILON should be true unless good reasons.
 // default : true, 0.f, 0., and 0..
-#define OMNI_USE_STD_EPSILON true
-#define OMNI_FLT_EPSILON 0.f
-#define OMNI_DBL_EPSILON 0.
-#define OMNI_LDBL_EPSILON 0.
+#ifndef OMNI_USE_STD_EPSILON
+  #define OMNI_USE_STD_EPSILON true
+#endif
+#ifndef OMNI_FLT_EPSILON
+  #define OMNI_FLT_EPSILON 0.f
+#endif
+#ifndef OMNI_DBL_EPSILON
+  #define OMNI_DBL_EPSILON 0.
+#endif
+#ifndef OMNI_LDBL_EPSILON
+  #define OMNI_LDBL_EPSILON 0.
+#endif
 
 // if OMNI_COMPARISON_USE_STD_EPSILON is true, all comparisons between units (through
 // comparison operators == != <= < > >=) are done according to
 // default epsilon (FLT_EPSILON, DBL_EPSILON...). Else, these comparisons are done with
 // the value of OMNI_COMPARISON_FLT_EPSILON, OMNI_COMPARISON_DBL_EPSILON and OMNI_COMPARISON_LDBL_EPSILON.
 // default : true, 0.f, 0., and 0..
-#define OMNI_COMPARISON_USE_STD_EPSILON true
-#define OMNI_COMPARISON_FLT_EPSILON 0.f
-#define OMNI_COMPARISON_DBL_EPSILON 0.
-#define OMNI_COMPARISON_LDBL_EPSILON 0.
+#ifndef OMNI_COMPARISON_USE_STD_EPSILON
+  #define OMNI_COMPARISON_USE_STD_EPSILON true
+#endif
+#ifndef OMNI_COMPARISON_FLT_EPSILON
+  #define OMNI_COMPARISON_FLT_EPSILON 0.f
+#endif
+#ifndef OMNI_COMPARISON_DBL_EPSILON
+  #define OMNI_COMPARISON_DBL_EPSILON 0.
+#endif
+#ifndef OMNI_COMPARISON_LDBL_EPSILON
+  #define OMNI_COMPARISON_LDBL_EPSILON 0.
+#endif
 
 // if OMNI_USE_UNCERTAINTIES is true, then uncertainties
 // are propagated through arithmetic operations and functions.
 // Set it to false to speed up runtime execution.
 // default : false
-#define OMNI_USE_UNCERTAINTIES false
+#ifndef OMNI_USE_UNCERTAINTIES
+  #define OMNI_USE_UNCERTAINTIES false
+#endif
 
 // OMNI_NUMBER_OF_SYSTEM_ERROR_BEFORE_QUAD_SUM is the amount of
 // systematic errors under/at which they are lineary added and
 // above which they are quadratically added. Set it to 0 to never use quadratic sum.
 // default : 3
-#define OMNI_NUMBER_OF_SYSTEM_ERROR_BEFORE_QUAD_SUM 3
+#ifndef OMNI_NUMBER_OF_SYSTEM_ERROR_BEFORE_QUAD_SUM
+  #define OMNI_NUMBER_OF_SYSTEM_ERROR_BEFORE_QUAD_SUM 3
+#endif
+
+// OMNI_INTEGER_ROUNDING is how conversions between units with integer representations
+// round when the result is not exact (1499 millimeter<int> to meter<int>) : one of
+// TowardZero, Nearest (halfway cases away from zero), Down or Up (see omni::Rounding).
+// unit_cast(Obj, omni::Rounding::...) chooses it for a single conversion.
+// default : TowardZero
+#ifndef OMNI_INTEGER_ROUNDING
+  #define OMNI_INTEGER_ROUNDING TowardZero
+#endif
+
+// if OMNI_CHECK_INTEGER_OVERFLOW is true, conversions between units with integer
+// representations throw std::overflow_error when the result does not fit
+// (a compilation error in constant expressions). Otherwise they wrap around, as
+// they always did, without any check. Only conversions which can overflow are checked
+// (a larger scale, an origin, or a narrower representation).
+// Integer representations (omni::checked<>, saturating<>, wrapping<>) have their own policy.
+// default : false
+#ifndef OMNI_CHECK_INTEGER_OVERFLOW
+  #define OMNI_CHECK_INTEGER_OVERFLOW false
+#endif
+
+// OMNI_L2_CACHE_SIZE is the size in bytes of the level 2 cache of a core : the parallel
+// algorithms of ./include/omniunit/parallel.hh cut their ranges in chunks whose
+// elements fill half of it.
+// default : 262144 (256 KiB)
+#ifndef OMNI_L2_CACHE_SIZE
+  #define OMNI_L2_CACHE_SIZE 262144
+#endif
 
 #endif //OMNIUNIT_SETTINGS_HH_
\ No newline at end of file
@@ -0,0 +1,344 @@
+//sharded.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_SHARDED_HH_
+#define OMNIUNIT_SHARDED_HH_
+
+// omni::sharded_accumulator<U> is a sum of units written by many threads : each thread
+// adds to its own slot, on its own cache line, with plain loads and stores (relaxed
+// atomics, no read-modify-write), so that writers never share a cache line.
+// sum() combines the slots on demand. With Variance = true, the slots also keep
+// Welford's running mean and variance of the added units, and count(), mean() and
+// variance() combine them with Chan's formula.
+//
+// a thread gets a slot at its first addition to an accumulator. When the thread
+// exits, its slot is folded into the accumulator and reused by the next thread that
+// registers. Destroying an accumulator while threads add to it is undefined, as for
+// any object.
+//
+// operator+= accepts any unit of the same dimension, converted as in Unit::operator+=.
+// Counts are added in double (long double for long double Reps), and exactly in their
+// Rep for integer Reps. The results have no uncertainty.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/Unit.hh"
+#include "core/kernels.hh"
+
+
+
+namespace omni
+{
+
+
+
+namespace sharded_detail
+{
+
+
+inline std::atomic<std::uint64_t> nextId{1};
+
+
+//integer Reps are added exactly in their Rep
+template <typename Rep>
+using accumulator_t = typename std::conditional<is_integer_rep<Rep>::value, Rep, kernel_detail::accumulator_t<Rep>>::type;
+
+
+//n, mean and m2 of the union of two sets of samples
+inline void chan(std::uint64_t& n, double& mean, double& m2, std::uint64_t otherN, double otherMean, double otherM2)
+{
+  if(otherN == 0)
+    return;
+  std::uint64_t total = n + otherN;
+  double delta = otherMean - mean;
+  double weight = static_cast<double>(otherN) / static_cast<double>(total);
+  mean += delta * weight;
+  m2 += otherM2 + delta * delta * static_cast<double>(n) * weight;
+  n = total;
+}
+
+
+} //namespace sharded_detail
+
+
+
+template <typename U, bool Variance = false>
+class sharded_accumulator
+{
+  static_assert(is_Unit<U>::value, "omni::sharded_accumulator adds omni::Unit.");
+
+  typedef typename U::rep rep;
+  typedef typename U::dim dim;
+  typedef sharded_detail::accumulator_t<rep> acc;
+
+  template <typename T>
+  using enable_same_dimension = typename std::enable_if<is_Unit<T>::value && std::is_same<typename T::dim, dim>::value>::type;
+
+  public:
+
+  typedef U value_type;
+  typedef decltype(pow<2>(std::declval<U>())) variance_type;
+
+
+  sharded_accumulator():
+  _state(std::make_shared<State>())
+  {
+  }
+
+  sharded_accumulator(sharded_accumulator const&) = delete;
+  sharded_accumulator& operator=(sharded_accumulator const&) = delete;
+
+
+  template <typename T, typename = enable_same_dimension<T>>
+  sharded_accumulator& operator+=(T const& value)
+  {
+    Slot& slot = local();
+    acc count = static_cast<acc>(Unit<dim, rep, typename U::period, T::origin>(value).count());
+
+    if constexpr(Variance)
+    {
+      unsigned sequence = slot.sequence.load(std::memory_order_relaxed);
+      slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      std::uint64_t n = slot.n.load(std::memory_order_relaxed) + 1;
+      double mean = slot.mean.load(std::memory_order_relaxed);
+      double x = static_cast<double>(count);
+      double delta = x - mean;
+      mean += delta / static_cast<double>(n);
+      slot.n.store(n, std::memory_order_relaxed);
+      slot.mean.store(mean, std::memory_order_relaxed);
+      slot.m2.store(slot.m2.load(std::memory_order_relaxed) + delta * (x - mean), std::memory_order_relaxed);
+      slot.sum.store(static_cast<acc>(slot.sum.load(std::memory_order_relaxed) + count), std::memory_order_relaxed);
+
+      slot.sequence.store(sequence + 2, std::memory_order_release);
+    }
+    else
+    {
+      slot.sum.store(static_cast<acc>(slot.sum.load(std::memory_order_relaxed) + count), std::memory_order_relaxed);
+    }
+    return *this;
+  }
+
+
+  U sum() const
+  {
+    return U(static_cast<rep>(combine().sum));
+  }
+
+  std::uint64_t count() const
+  {
+    static_assert(Variance, "count() needs a sharded_accumulator<U, true>.");
+    return combine().n;
+  }
+
+  U mean() const
+  {
+    static_assert(Variance, "mean() needs a sharded_accumulator<U, true>.");
+    return U(static_cast<rep>(combine().mean));
+  }
+
+  //population variance of the added units, zero before two additions
+  variance_type variance() const
+  {
+    static_assert(Variance, "variance() needs a sharded_accumulator<U, true>.");
+    Totals totals = combine();
+    double variance = totals.n > 1 ? totals.m2 / static_cast<double>(totals.n) : 0.;
+    return variance_type(static_cast<typename variance_type::rep>(variance));
+  }
+
+
+  private:
+
+  struct alignas(kernel_detail::cacheLine) Slot
+  {
+    std::atomic<acc> sum{static_cast<acc>(0)};
+    std::atomic<unsigned> sequence{0};
+    std::atomic<std::uint64_t> n{0};
+    std::atomic<double> mean{0.};
+    std::atomic<double> m2{0.};
+  };
+
+
+  struct Totals
+  {
+    acc sum = static_cast<acc>(0);
+    std::uint64_t n = 0;
+    double mean = 0.;
+    double m2 = 0.;
+  };
+
+
+  struct State
+  {
+    std::uint64_t const id = sharded_detail::nextId.fetch_add(1, std::memory_order_relaxed);
+    std::mutex mutex{};
+    std::vector<std::unique_ptr<Slot>> slots{};
+    std::vector<Slot*> freeSlots{};
+    Totals retired{};
+
+
+    Slot* acquire()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if(!freeSlots.empty())
+      {
+        Slot* slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+      }
+      slots.push_back(std::make_unique<Slot>());
+      return slots.back().get();
+    }
+
+
+    //called by the owner of the slot, when it exits
+    void release(Slot* slot)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      Totals totals = read(*slot);
+      retired.sum = static_cast<acc>(retired.sum + totals.sum);
+      sharded_detail::chan(retired.n, retired.mean, retired.m2, totals.n, totals.mean, totals.m2);
+      slot->sum.store(static_cast<acc>(0), std::memory_order_relaxed);
+      slot->n.store(0, std::memory_order_relaxed);
+      slot->mean.store(0., std::memory_order_relaxed);
+      slot->m2.store(0., std::memory_order_relaxed);
+      freeSlots.push_back(slot);
+    }
+  };
+
+
+  //slots of the accumulators a thread added to, released when the thread exits
+  struct Registry
+  {
+    struct Entry
+    {
+      std::weak_ptr<State> state;
+      Slot* slot;
+    };
+
+    std::uint64_t lastId = 0;
+    Slot* lastSlot = nullptr;
+    std::unordered_map<std::uint64_t, Entry> entries{};
+
+    Registry() = default;
+    Registry(Registry const&) = delete;
+    Registry& operator=(Registry const&) = delete;
+
+    ~Registry()
+    {
+      for(auto& entry : entries)
+        if(std::shared_ptr<State> state = entry.second.state.lock())
+          state->release(entry.second.slot);
+    }
+  };
+
+
+  static Totals read(Slot const& slot)
+  {
+    Totals totals;
+    if constexpr(Variance)
+    {
+      unsigned before = 0;
+      unsigned after = 0;
+      do
+      {
+        before = slot.sequence.load(std::memory_order_acquire);
+        totals.sum = slot.sum.load(std::memory_order_relaxed);
+        totals.n = slot.n.load(std::memory_order_relaxed);
+        totals.mean = slot.mean.load(std::memory_order_relaxed);
+        totals.m2 = slot.m2.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot.sequence.load(std::memory_order_relaxed);
+      } while(before != after || (before & 1u) != 0);
+    }
+    else
+    {
+      totals.sum = slot.sum.load(std::memory_order_relaxed);
+    }
+    return totals;
+  }
+
+
+  Totals combine() const
+  {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    Totals totals = _state->retired;
+    for(std::unique_ptr<Slot> const& slot : _state->slots)
+    {
+      Totals other = read(*slot);
+      totals.sum = static_cast<acc>(totals.sum + other.sum);
+      sharded_detail::chan(totals.n, totals.mean, totals.m2, other.n, other.mean, other.m2);
+    }
+    return totals;
+  }
+
+
+  Slot& local()
+  {
+    static thread_local Registry registry;
+    std::uint64_t id = _state->id;
+    if(registry.lastId == id)
+      return *registry.lastSlot;
+
+    auto found = registry.entries.find(id);
+    if(found == registry.entries.end())
+    {
+      for(auto entry = registry.entries.begin(); entry != registry.entries.end();)
+        entry = entry->second.state.expired() ? registry.entries.erase(entry) : std::next(entry);
+      found = registry.entries.emplace(id, typename Registry::Entry{_state, _state->acquire()}).first;
+    }
+    registry.lastId = id;
+    registry.lastSlot = found->second.slot;
+    return *registry.lastSlot;
+  }
+
+
+  std::shared_ptr<State> _state;
+};
+
+
+
+} //namespace omni
+
+#endif //OMNIUNIT_SHARDED_HH_
@@ -0,0 +1,302 @@
+//thread_pool.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_THREAD_POOL_HH_
+#define OMNIUNIT_THREAD_POOL_HH_
+
+// omni::parallel::ThreadPool runs the chunks of the parallel algorithms of parallel.hh
+// and of the threaded omni::sum and omni::reduce of reduce.hh.
+//
+// run(number, task) calls task(k) for every k in [0, number) on the threads of the pool,
+// the calling thread included. Each thread first takes the indices of its own contiguous
+// slice, then steals indices from the end of the slices of the others. A pool built
+// with pinned = true binds its threads to cores (Linux only). A run started from a
+// task of the same pool runs on the calling thread, and an exception thrown by a task
+// is rethrown by run() once the running tasks are done.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+
+
+namespace omni
+{
+namespace parallel
+{
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== THREAD POOL =============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+class ThreadPool
+{
+  public:
+
+  //threads counts the calling thread : 0 for std::thread::hardware_concurrency()
+  explicit ThreadPool(unsigned threads = 0, bool pinned = false):
+  _slices(), _workers(), _mutex(), _wake(), _done(), _submit(), _task(nullptr),
+  _generation(0), _busy(0), _stop(false), _failed(false), _error()
+  {
+    if(threads == 0)
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    _slices = std::vector<Slice>(threads);
+    for(unsigned i = 1; i < threads; i++)
+    {
+      _workers.emplace_back([this, i] {work(i);});
+      if(pinned)
+        pin(_workers.back(), i);
+    }
+  }
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    for(std::thread& worker : _workers)
+      worker.join();
+  }
+
+
+  std::size_t size() const
+  {
+    return _slices.size();
+  }
+
+
+  //calls task(k) for every k in [0, number), and returns when all calls are done
+  void run(std::size_t number, std::function<void(std::size_t)> const& task)
+  {
+    if(number == 0)
+      return;
+    if(number == 1 || _slices.size() == 1 || current() == this)
+    {
+      for(std::size_t k = 0; k < number; k++)
+        task(k);
+      return;
+    }
+
+    std::lock_guard<std::mutex> submit(_submit);
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      std::size_t slices = _slices.size();
+      for(std::size_t s = 0; s < slices; s++)
+      {
+        std::lock_guard<std::mutex> sliceLock(_slices[s].mutex);
+        _slices[s].begin = s * number / slices;
+        _slices[s].end = (s + 1) * number / slices;
+      }
+      _task = &task;
+      _failed = false;
+      _error = nullptr;
+      _generation++;
+      _busy++;
+    }
+    _wake.notify_all();
+
+    ThreadPool* previous = current();
+    current() = this;
+    drain(0, task);
+    current() = previous;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _busy--;
+    _done.wait(lock, [this] {return _busy == 0;});
+    _task = nullptr;
+    if(_error)
+      std::rethrow_exception(_error);
+  }
+
+
+  static ThreadPool& instance()
+  {
+    static ThreadPool pool;
+    return pool;
+  }
+
+
+  private:
+
+  //indices [begin, end) not taken yet : the owner takes begin, thieves take end - 1
+  struct Slice
+  {
+    std::mutex mutex{};
+    std::size_t begin = 0;
+    std::size_t end = 0;
+  };
+
+
+  static ThreadPool*& current()
+  {
+    static thread_local ThreadPool* pool = nullptr;
+    return pool;
+  }
+
+
+  static void pin(std::thread& worker, unsigned index)
+  {
+#if defined(__linux__)
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cores, &set);
+    pthread_setaffinity_np(worker.native_handle(), sizeof(cpu_set_t), &set);
+#else
+    static_cast<void>(worker);
+    static_cast<void>(index);
+#endif
+  }
+
+
+  bool take(std::size_t owner, std::size_t& index)
+  {
+    {
+      Slice& slice = _slices[owner];
+      std::lock_guard<std::mutex> lock(slice.mutex);
+      if(slice.begin < slice.end)
+      {
+        index = slice.begin++;
+        return true;
+      }
+    }
+    std::size_t slices = _slices.size();
+    for(std::size_t s = 1; s < slices; s++)
+    {
+      Slice& victim = _slices[(owner + s) % slices];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if(victim.begin < victim.end)
+      {
+        index = --victim.end;
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  void drain(std::size_t owner, std::function<void(std::size_t)> const& task)
+  {
+    std::size_t index = 0;
+    while(take(owner, index))
+    {
+      if(_failed.load(std::memory_order_relaxed))
+        continue;
+      try
+      {
+        task(index);
+      }
+      catch(...)
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!_error)
+          _error = std::current_exception();
+        _failed = true;
+      }
+    }
+  }
+
+
+  void work(std::size_t owner)
+  {
+    current() = this;
+    std::size_t seen = 0;
+    while(true)
+    {
+      std::function<void(std::size_t)> const* task = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wake.wait(lock, [&] {return _stop || (_task != nullptr && _generation != seen);});
+        if(_stop)
+          return;
+        seen = _generation;
+        task = _task;
+        _busy++;
+      }
+      drain(owner, *task);
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _busy--;
+      }
+      _done.notify_all();
+    }
+  }
+
+
+  std::vector<Slice> _slices;
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _done;
+  std::mutex _submit;
+  std::function<void(std::size_t)> const* _task;
+  std::size_t _generation;
+  std::size_t _busy;
+  bool _stop;
+  std::atomic<bool> _failed;
+  std::exception_ptr _error;
+};
+
+
+
+} //namespace parallel
+} //namespace omni
+
+
+
+#endif //OMNIUNIT_THREAD_POOL_HH_
@@ -0,0 +1,685 @@
+//unit_expression.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_UNIT_EXPRESSION_HH_
+#define OMNIUNIT_UNIT_EXPRESSION_HH_
+
+// omni::unit_t<"kg*m/s^2"> is the unit type written by the string, parsed at
+// compile time (C++20 : strings are template parameters). The type is exactly
+// the one the same expression gives with objects :
+//   unit_t<"kg*m/s^2">  ==  decltype(kilogram<>() * meter<>() / pow<2>(second<>()))
+// so expressions written one way or the other mix without any conversion.
+//
+// grammar : products with '*', '.', '·' or a space, quotients with '/',
+// parentheses, exponents with '^' (signed integer), '²' or '³', and "1" as
+// numerator ("1/s"). Symbols are listed in symbolTable below ; SI prefixes
+// (Y Z E P T G M k h da d c m u µ n p f a z y) apply to the symbols marked so.
+// A prefixed symbol is the header's prefixed type when there is one ("km" is
+// kilometer, "cg" is centigram, "mbar" is millibar). Errors stop the compilation on a call to one
+// of the unit_expression_* functions, whose name tells what is wrong.
+
+#if __cplusplus >= 202002L
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+#include "core/Unit.hh"
+#include "units/dimensionless_angle.hh"
+#include "units/duration.hh"
+#include "units/electric_intensity.hh"
+#include "units/energy.hh"
+#include "units/force.hh"
+#include "units/length.hh"
+#include "units/luminous_intensity.hh"
+#include "units/mass.hh"
+#include "units/power.hh"
+#include "units/pressure.hh"
+#include "units/quantity.hh"
+#include "units/temperature.hh"
+#include "units/temporary.hh"
+
+
+
+namespace omni
+{
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== STRING AS TEMPLATE PARAMETER ============================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <std::size_t N>
+struct fixed_string
+{
+  constexpr fixed_string(char const (&str)[N])
+  {
+    for(std::size_t i = 0; i < N; i++)
+      data[i] = str[i];
+  }
+
+  constexpr std::size_t size() const
+  {
+    return N - 1;
+  }
+
+  char data[N] = {};
+};
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== SYMBOL TABLE ============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+namespace unit_expression_detail
+{
+
+
+//decimal is the power of ten of the symbol's period, used to land on the
+//prefixed types of the headers. noDecimal : prefixes multiply the period.
+inline constexpr int noDecimal = 1000;
+
+
+struct symbol
+{
+  char const* name;
+  bool prefixable;
+  int decimal;
+};
+
+
+//same order as symbolUnits
+inline constexpr symbol symbolTable[] =
+{
+  {"m", true, 0}, {"g", true, -3}, {"kg", false, 0}, {"t", true, 3},
+  {"s", true, 0}, {"min", false, 0}, {"h", false, 0}, {"d", false, 0},
+  {"A", true, 0}, {"K", true, 0}, {"degC", false, 0}, {"\xC2\xB0" "C", false, 0},
+  {"degF", false, 0}, {"\xC2\xB0" "F", false, 0}, {"mol", true, 0}, {"cd", true, 0},
+  {"N", true, 0}, {"J", true, 0}, {"W", true, 0}, {"Pa", true, 0},
+  {"bar", true, 5}, {"atm", false, 0}, {"Hz", true, 0}, {"L", true, -3},
+  {"l", true, -3}, {"rad", true, 0}, {"sr", false, 0}, {"deg", false, 0},
+  {"\xC2\xB0", false, 0}, {"eV", true, noDecimal}, {"Wh", true, noDecimal}, {"cal", false, 0},
+  {"kcal", false, 0}, {"in", false, 0}, {"ft", false, 0}, {"yd", false, 0},
+  {"mi", false, 0}, {"lb", false, 0}, {"oz", false, 0}, {"hp", false, 0}
+};
+
+
+template <typename Rep>
+using symbolUnits = std::tuple<
+  meter<Rep>, gram<Rep>, kilogram<Rep>, ton<Rep>,
+  second<Rep>, minute<Rep>, hour<Rep>, day<Rep>,
+  ampere<Rep>, kelvin<Rep>, celsius<Rep>, celsius<Rep>,
+  fahrenheit<Rep>, fahrenheit<Rep>, mol<Rep>, candela<Rep>,
+  newton<Rep>, joule<Rep>, watt<Rep>, pascal_t<Rep>,
+  bar<Rep>, atmosphere<Rep>, hertz<Rep>, liter<Rep>,
+  liter<Rep>, radian<Rep>, steradian<Rep>, degree<Rep>,
+  degree<Rep>, ev<Rep>, wattHour<Rep>, calorie<Rep>,
+  kilocalorie<Rep>, inch<Rep>, foot<Rep>, yard<Rep>,
+  mile<Rep>, pound<Rep>, ounce<Rep>, horsepower<Rep>>;
+
+
+static_assert(std::tuple_size<symbolUnits<double>>::value == sizeof(symbolTable) / sizeof(symbol),
+"symbolTable and symbolUnits must list the same symbols.");
+
+
+struct prefix
+{
+  char const* name;
+  int decimal;
+};
+
+
+//two-letter prefix first, so that "dam" is a decameter
+inline constexpr prefix prefixTable[] =
+{
+  {"da", 1}, {"Y", 24}, {"Z", 21}, {"E", 18}, {"P", 15}, {"T", 12}, {"G", 9},
+  {"M", 6}, {"k", 3}, {"h", 2}, {"d", -1}, {"c", -2}, {"m", -3}, {"u", -6},
+  {"\xC2\xB5", -6}, {"\xCE\xBC", -6}, {"n", -9}, {"p", -12}, {"f", -15},
+  {"a", -18}, {"z", -21}, {"y", -24}
+};
+
+
+//powers of ten written like the prefixes of the headers : Ratio<E3, E0> is kilo,
+//Ratio<E0, E5> the period of centigram
+inline constexpr double const* powersOfTen[] =
+{
+  &E0, &E1, &E2, &E3, &E4, &E5, &E6, &E7, &E8, &E9, &E10, &E11, &E12, &E13, &E14,
+  &E15, &E16, &E17, &E18, &E19, &E20, &E21, &E22, &E23, &E24, &E25, &E26, &E27,
+  &E28, &E29, &E30
+};
+
+inline constexpr int maxDecimal = 30;
+
+
+template <int decimal, bool = (decimal >= 0)>
+struct decimal_ratio
+{
+  typedef Ratio<*powersOfTen[decimal], E0> type;
+};
+
+template <int decimal>
+struct decimal_ratio<decimal, false>
+{
+  typedef Ratio<E0, *powersOfTen[-decimal]> type;
+};
+
+
+constexpr int symbol_index(char const* name)
+{
+  for(std::size_t i = 0; i < sizeof(symbolTable) / sizeof(symbol); i++)
+  {
+    std::size_t c = 0;
+    while(name[c] != '\0' && name[c] == symbolTable[i].name[c])
+      c++;
+    if(name[c] == '\0' && symbolTable[i].name[c] == '\0')
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+
+//prefixed types of the headers whose period is not a power of ten
+template <typename Rep, int index, int prefixDecimal>
+struct named_prefixed
+{
+  typedef void type;
+};
+
+template <typename Rep> struct named_prefixed<Rep, symbol_index("bar"), -3> {typedef millibar<Rep> type;};
+template <typename Rep> struct named_prefixed<Rep, symbol_index("bar"), -1> {typedef decibar<Rep> type;};
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== PARSER ==================================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//never constexpr : reaching one of them during the parse is the compile error
+inline void unit_expression_unknown_symbol() {}
+inline void unit_expression_unexpected_character() {}
+inline void unit_expression_missing_parenthesis() {}
+inline void unit_expression_missing_exponent() {}
+inline void unit_expression_too_long() {}
+
+
+//the expression in postfix order : the evaluation below is a stack machine
+struct operation
+{
+  char kind = 0; // 's' symbol, '1' one, '*', '/', '^'
+  int symbol = 0;
+  int prefix = 0;
+  int exponent = 0;
+};
+
+
+struct program
+{
+  static constexpr std::size_t capacity = 64;
+
+  operation ops[capacity] = {};
+  std::size_t size = 0;
+};
+
+
+class parser
+{
+public:
+  constexpr parser(char const* str, std::size_t size):
+  _str(str),
+  _size(size),
+  _pos(0),
+  _program()
+  {
+  }
+
+
+  constexpr program parse()
+  {
+    product();
+    skipSpaces();
+    if(_pos != _size)
+      unit_expression_unexpected_character();
+    return _program;
+  }
+
+
+private:
+  constexpr bool at(char const* text) const
+  {
+    std::size_t i = 0;
+    for(; text[i] != '\0'; i++)
+      if(_pos + i >= _size || _str[_pos + i] != text[i])
+        return false;
+    return true;
+  }
+
+
+  constexpr std::size_t symbolBytes(std::size_t pos) const
+  {
+    if(pos >= _size)
+      return 0;
+    char c = _str[pos];
+    if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+      return 1;
+    if(pos + 1 < _size)
+    {
+      unsigned char c0 = static_cast<unsigned char>(c);
+      unsigned char c1 = static_cast<unsigned char>(_str[pos + 1]);
+      // ° µ μ
+      if((c0 == 0xC2 && (c1 == 0xB0 || c1 == 0xB5)) || (c0 == 0xCE && c1 == 0xBC))
+        return 2;
+    }
+    return 0;
+  }
+
+
+  static constexpr bool equal(char const* str, std::size_t size, char const* text)
+  {
+    std::size_t i = 0;
+    for(; i < size; i++)
+      if(text[i] == '\0' || text[i] != str[i])
+        return false;
+    return text[i] == '\0';
+  }
+
+
+  static constexpr int find(char const* str, std::size_t size, bool needPrefixable)
+  {
+    for(std::size_t i = 0; i < sizeof(symbolTable) / sizeof(symbol); i++)
+      if((!needPrefixable || symbolTable[i].prefixable) && equal(str, size, symbolTable[i].name))
+        return static_cast<int>(i);
+    return -1;
+  }
+
+
+  constexpr void emit(operation op)
+  {
+    if(_program.size == program::capacity)
+      unit_expression_too_long();
+    _program.ops[_program.size++] = op;
+  }
+
+
+  constexpr void skipSpaces()
+  {
+    while(_pos < _size && _str[_pos] == ' ')
+      _pos++;
+  }
+
+
+  constexpr void symbolFactor()
+  {
+    std::size_t begin = _pos;
+    while(symbolBytes(_pos) != 0)
+      _pos += symbolBytes(_pos);
+
+    char const* token = _str + begin;
+    std::size_t length = _pos - begin;
+
+    int index = find(token, length, false);
+    if(index >= 0)
+    {
+      emit({'s', index, 0, 0});
+      return;
+    }
+    for(prefix const& p : prefixTable)
+    {
+      std::size_t prefixLength = 0;
+      while(p.name[prefixLength] != '\0')
+        prefixLength++;
+      if(prefixLength < length && equal(token, prefixLength, p.name))
+      {
+        index = find(token + prefixLength, length - prefixLength, true);
+        if(index >= 0)
+        {
+          emit({'s', index, p.decimal, 0});
+          return;
+        }
+      }
+    }
+    unit_expression_unknown_symbol();
+  }
+
+
+  constexpr void exponent()
+  {
+    skipSpaces();
+    if(at("\xC2\xB2") || at("\xC2\xB3"))
+    {
+      emit({'^', 0, 0, at("\xC2\xB2") ? 2 : 3});
+      _pos += 2;
+      return;
+    }
+    if(!at("^"))
+      return;
+    _pos++;
+    skipSpaces();
+    bool negative = false;
+    if(at("-") || at("+"))
+    {
+      negative = at("-");
+      _pos++;
+    }
+    if(_pos >= _size || _str[_pos] < '0' || _str[_pos] > '9')
+      unit_expression_missing_exponent();
+    int value = 0;
+    while(_pos < _size && _str[_pos] >= '0' && _str[_pos] <= '9')
+      value = value * 10 + (_str[_pos++] - '0');
+    emit({'^', 0, 0, negative ? -value : value});
+  }
+
+
+  constexpr void factor()
+  {
+    skipSpaces();
+    if(at("("))
+    {
+      _pos++;
+      product();
+      skipSpaces();
+      if(!at(")"))
+        unit_expression_missing_parenthesis();
+      _pos++;
+    }
+    else if(at("1") && !(_pos + 1 < _size && _str[_pos + 1] >= '0' && _str[_pos + 1] <= '9'))
+    {
+      _pos++;
+      emit({'1', 0, 0, 0});
+    }
+    else if(symbolBytes(_pos) != 0)
+      symbolFactor();
+    else
+      unit_expression_unexpected_character();
+    exponent();
+  }
+
+
+  constexpr void product()
+  {
+    factor();
+    while(true)
+    {
+      skipSpaces();
+      if(at("*") || at(".") || at("\xC2\xB7"))
+      {
+        _pos += at("\xC2\xB7") ? 2u : 1u;
+        factor();
+        emit({'*', 0, 0, 0});
+      }
+      else if(at("/"))
+      {
+        _pos++;
+        factor();
+        emit({'/', 0, 0, 0});
+      }
+      else if(at("(") || symbolBytes(_pos) != 0)
+      {
+        factor();
+        emit({'*', 0, 0, 0});
+      }
+      else
+        return;
+    }
+  }
+
+
+  char const* _str;
+  std::size_t _size;
+  std::size_t _pos;
+  program _program;
+};
+
+
+//parsed once per string, whatever the Rep
+template <fixed_string S>
+struct parsed
+{
+  static constexpr program value = parser(S.data, S.size()).parse();
+};
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== EVALUATION ==============================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+//the "1" of "1/s"
+struct one
+{
+};
+
+
+template <typename Rep, int index, int prefixDecimal>
+struct symbol_unit
+{
+  typedef typename std::tuple_element<static_cast<std::size_t>(index), symbolUnits<Rep>>::type unit;
+  static constexpr int decimal = symbolTable[index].decimal + prefixDecimal;
+
+  typedef typename named_prefixed<Rep, index, prefixDecimal>::type named;
+
+  template <bool onTable, typename = void>
+  struct pick
+  {
+    typedef Unit<typename unit::dim, Rep, typename Ratio_times_Ratio<typename unit::period, typename decimal_ratio<prefixDecimal>::type>::type, unit::origin> type;
+  };
+
+  template <typename dummy>
+  struct pick<true, dummy>
+  {
+    typedef Unit<typename unit::dim, Rep, typename decimal_ratio<decimal>::type, unit::origin> type;
+  };
+
+  static constexpr bool onTable = symbolTable[index].decimal != noDecimal && decimal >= -maxDecimal && decimal <= maxDecimal;
+
+  typedef typename std::conditional<prefixDecimal == 0, unit,
+          typename std::conditional<!std::is_void<named>::value, named, typename pick<onTable>::type>::type>::type type;
+};
+
+
+//the types of operator*, operator/ and pow<>()
+template <typename unit1, typename unit2>
+struct multiply
+{
+  typedef decltype(std::declval<unit1>() * std::declval<unit2>()) type;
+};
+
+template <typename unit2>
+struct multiply<one, unit2>
+{
+  typedef unit2 type;
+};
+
+template <typename unit1>
+struct multiply<unit1, one>
+{
+  typedef unit1 type;
+};
+
+template <>
+struct multiply<one, one>
+{
+  typedef one type;
+};
+
+
+template <typename unit1, typename unit2>
+struct divide
+{
+  typedef decltype(std::declval<unit1>() / std::declval<unit2>()) type;
+};
+
+template <typename unit2>
+struct divide<one, unit2>
+{
+  typedef decltype(std::declval<typename unit2::rep>() / std::declval<unit2>()) type;
+};
+
+template <typename unit1>
+struct divide<unit1, one>
+{
+  typedef unit1 type;
+};
+
+template <>
+struct divide<one, one>
+{
+  typedef one type;
+};
+
+
+template <typename unit, int exponent>
+struct power
+{
+  typedef decltype(pow<exponent>(std::declval<unit>())) type;
+};
+
+template <int exponent>
+struct power<one, exponent>
+{
+  typedef one type;
+};
+
+
+template <typename top, typename rest>
+struct stack
+{
+  typedef top first;
+  typedef rest others;
+};
+
+
+template <typename Rep, operation op, typename Stack>
+struct step;
+
+template <typename Rep, operation op, typename Stack>
+requires (op.kind == 's')
+struct step<Rep, op, Stack>
+{
+  typedef stack<typename symbol_unit<Rep, op.symbol, op.prefix>::type, Stack> type;
+};
+
+template <typename Rep, operation op, typename Stack>
+requires (op.kind == '1')
+struct step<Rep, op, Stack>
+{
+  typedef stack<one, Stack> type;
+};
+
+template <typename Rep, operation op, typename Stack>
+requires (op.kind == '^')
+struct step<Rep, op, Stack>
+{
+  typedef stack<typename power<typename Stack::first, op.exponent>::type, typename Stack::others> type;
+};
+
+template <typename Rep, operation op, typename Stack>
+requires (op.kind == '*')
+struct step<Rep, op, Stack>
+{
+  typedef stack<typename multiply<typename Stack::others::first, typename Stack::first>::type, typename Stack::others::others> type;
+};
+
+template <typename Rep, operation op, typename Stack>
+requires (op.kind == '/')
+struct step<Rep, op, Stack>
+{
+  typedef stack<typename divide<typename Stack::others::first, typename Stack::first>::type, typename Stack::others::others> type;
+};
+
+
+template <typename Rep, program const& prog, std::size_t index, typename Stack>
+struct evaluate
+{
+  typedef typename evaluate<Rep, prog, index + 1, typename step<Rep, prog.ops[index], Stack>::type>::type type;
+};
+
+template <typename Rep, program const& prog, std::size_t index, typename Stack>
+requires (index == prog.size)
+struct evaluate<Rep, prog, index, Stack>
+{
+  typedef typename std::conditional<std::is_same<typename Stack::first, one>::value,
+    Unit<Dimensionless, Rep, base, zero>, typename Stack::first>::type type;
+};
+
+
+} //namespace unit_expression_detail
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== UNIT EXPRESSION =========================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+template <fixed_string S, typename Rep = OMNI_DEFAULT_TYPE>
+using unit_t = typename unit_expression_detail::evaluate<Rep, unit_expression_detail::parsed<S>::value, 0, void>::type;
+
+
+
+} //namespace omni
+
+#endif //__cplusplus >= 202002L
+
+#endif //OMNIUNIT_UNIT_EXPRESSION_HH_
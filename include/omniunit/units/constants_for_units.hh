@@ -35,6 +35,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef OMNIUNIT_CONSTANTS_FOR_UNITS_HH_
 #define OMNIUNIT_CONSTANTS_FOR_UNITS_HH_
 
+#include "../core/utility.hh"
+
 
 namespace omni
 {
@@ -59,10 +61,10 @@ inline constexpr double monthsPerYear = 12.; // mon
 inline constexpr double secondsPerYearE2 = 36525. * 24. *3600.; // s
 inline constexpr double distanceSunEarth = 149597870700.; //m
 inline constexpr double parsecDef = 648000.;
-inline constexpr double atomic_massDefE9 = 1660538921.; //kg * 10^-27
-inline constexpr double evPerC2DefE8 = 178266184.; //kg * 10^-36
+inline constexpr double atomic_massDefE9 = 1660539067.; //kg * 10^-27
+inline constexpr double evPerC2DefE8 = 178266192.; //kg * 10^-36
 inline constexpr double solar_massDefE4 = 19884.; //kg * 10^30
-inline constexpr double avogadroE9 = 6022140857.; //10^23 mol-1
+inline constexpr double avogadroE9 = 6022140760.; //10^23 mol-1
 inline constexpr double celsiusConstant = 273.15;
 inline constexpr double fahrenheitConstant = 459.67;
 inline constexpr double inchE2 = 254.; //cm
@@ -82,7 +84,7 @@ inline constexpr double poundE8 = 45359237.; //kg
 inline constexpr double ounceE10 = 283495231.; // kg
 inline constexpr double longtonDef = 1016.; //kg
 inline constexpr double shorttonE1 = 9072.; //kg
-inline constexpr double CoulombE9 = 1602176565.; //10^-19 C
+inline constexpr double CoulombE9 = 1602176634.; //10^-19 C
 inline constexpr double calorieE4 = 41855.; // J
 inline constexpr double btuDef = 1055.; // J
 inline constexpr double tonTNTE3 = 4184.; // 10^9 J
@@ -35,7 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef OMNIUNIT_LENGTH_HH_
 #define OMNIUNIT_LENGTH_HH_
 
-#include "../omniunit.hh"
+#include "../core/Unit.hh"
 #include"constants_for_units.hh"
 
 
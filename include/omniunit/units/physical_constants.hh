@@ -0,0 +1,172 @@
+//physical_constants.hh
+
+/*
+BSD 3-Clause License
+
+Copyright (c) 2021, Denis Tosetto alias Baxlan
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OMNIUNIT_PHYSICAL_CONSTANTS_HH_
+#define OMNIUNIT_PHYSICAL_CONSTANTS_HH_
+
+#include "../core/Unit.hh"
+
+// CODATA 2018 recommended values, as fully typed units in SI coherent units
+// (kilogram, meter, second, ampere, kelvin, mole, candela), so that
+// expressions such as kilogram<>(1.) * pow<2>(constants::c<>) fold at compile time.
+// the standard uncertainty is stored as the uncertainty of each constant
+// (zero for constants that are exact since the 2019 redefinition of the SI).
+// constants are variable templates on the Rep, like units are alias templates :
+// constants::G<> is a double, constants::G<float> a float.
+
+namespace omni
+{
+namespace constants
+{
+
+
+
+namespace constants_detail
+{
+
+template <int L, int M, int T, int I, int Theta, int N, int J, typename Rep>
+using si = Unit<Dimension<L,M,T,I,Theta,N,J>, Rep, base, zero>;
+
+} //namespace constants_detail
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== EXACT CONSTANTS =========================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+// speed of light in vacuum, m.s-1
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<1,0,-1,0,0,0,0, Rep> c(299792458., 0.);
+
+// Planck constant, J.s
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<2,1,-1,0,0,0,0, Rep> h(6.62607015e-34, 0.);
+
+// reduced Planck constant h/2pi, J.s
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<2,1,-1,0,0,0,0, Rep> hbar(1.0545718176461565e-34, 0.);
+
+// elementary charge, C
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<0,0,1,1,0,0,0, Rep> e(1.602176634e-19, 0.);
+
+// Boltzmann constant, J.K-1
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<2,1,-2,0,-1,0,0, Rep> k_B(1.380649e-23, 0.);
+
+// Avogadro constant, mol-1
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<0,0,0,0,0,-1,0, Rep> N_A(6.02214076e23, 0.);
+
+// molar gas constant N_A.k_B, J.mol-1.K-1
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<2,1,-2,0,-1,-1,0, Rep> R(8.31446261815324, 0.);
+
+// Faraday constant N_A.e, C.mol-1
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<0,0,1,1,0,-1,0, Rep> F(96485.33212331001, 0.);
+
+// Stefan-Boltzmann constant, W.m-2.K-4
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<0,1,-3,0,-4,0,0, Rep> sigma(5.6703744191844314e-8, 0.);
+
+// standard acceleration of gravity, m.s-2
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<1,0,-2,0,0,0,0, Rep> g_n(9.80665, 0.);
+
+
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//=== MEASURED CONSTANTS ======================================================
+//=============================================================================
+//=============================================================================
+//=============================================================================
+
+
+
+// Newtonian constant of gravitation, m3.kg-1.s-2
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<3,-1,-2,0,0,0,0, Rep> G(6.67430e-11, 0.00015e-11);
+
+// electron mass, kg
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<0,1,0,0,0,0,0, Rep> m_e(9.1093837015e-31, 0.0000000028e-31);
+
+// proton mass, kg
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<0,1,0,0,0,0,0, Rep> m_p(1.67262192369e-27, 0.00000000051e-27);
+
+// neutron mass, kg
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<0,1,0,0,0,0,0, Rep> m_n(1.67492749804e-27, 0.00000000095e-27);
+
+// atomic mass constant, kg
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<0,1,0,0,0,0,0, Rep> m_u(1.66053906660e-27, 0.00000000050e-27);
+
+// vacuum electric permittivity, F.m-1
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<-3,-1,4,2,0,0,0, Rep> epsilon_0(8.8541878128e-12, 0.0000000013e-12);
+
+// vacuum magnetic permeability, N.A-2
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<1,1,-2,-2,0,0,0, Rep> mu_0(1.25663706212e-6, 0.00000000019e-6);
+
+// fine-structure constant
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<0,0,0,0,0,0,0, Rep> alpha(7.2973525693e-3, 0.0000000011e-3);
+
+// Rydberg constant, m-1
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<-1,0,0,0,0,0,0, Rep> R_inf(10973731.568160, 0.000021);
+
+// Bohr radius, m
+template <typename Rep = OMNI_DEFAULT_TYPE>
+inline constexpr constants_detail::si<1,0,0,0,0,0,0, Rep> a_0(5.29177210903e-11, 0.00000000080e-11);
+
+
+
+} //namespace constants
+} //namespace omni
+
+#endif //OMNIUNIT_PHYSICAL_CONSTANTS_HH_
@@ -35,6 +35,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef OMNI_TEMP_HH_
 #define OMNI_TEMP_HH_
 
+#include "../core/Unit.hh"
+#include "constants_for_units.hh"
+#include "length.hh"
+#include "power.hh"
+#include "pressure.hh"
+
 
 
 namespace omni
@@ -53,6 +59,9 @@ namespace omni
   typedef Dimension<0,0,-1,0,0,0,0> Frequency;
   inline constexpr double perMinRatio = 60.;
 
+  template <typename Rep = OMNI_DEFAULT_TYPE>
+  using hertz = Unit<Frequency, Rep, base, zero>;
+
   template <typename Rep = OMNI_DEFAULT_TYPE>
   using perMinute = Unit<Frequency, Rep, Ratio<E0, perMinRatio>, zero>;
 
@@ -81,18 +90,15 @@ namespace omni
 
 
 
-  typedef mile<> Mile;
-  typedef inch<> Inch;
   typedef centimeter3<> Centimeter3;
   typedef liter<> Liter;
-  typedef watt<> Watt;
+  typedef hertz<> Hertz;
   typedef perMinute<> PerMinute;
   typedef meterPerSecond<> MeterPerSecond;
   typedef meterPerMinute<> MeterPerMinute;
   typedef kilometerPerHour<> KilometerPerHour;
   typedef meterPerSecond2<> MeterPerSecond2;
   typedef milePerHour<> MilePerHour;
-  typedef bar<> Bar;
 
   namespace suffixes
   {
@@ -100,6 +106,7 @@ namespace omni
 
   constexpr centimeter3<OMNI_LITTERAL_FLOATING> operator"" _cm3(long double val) {return val;}
   constexpr liter<OMNI_LITTERAL_FLOATING> operator"" _L(long double val) {return val;}
+  constexpr hertz<OMNI_LITTERAL_FLOATING> operator"" _Hz(long double val) {return val;}
   constexpr perMinute<OMNI_LITTERAL_FLOATING> operator"" _PerMin(long double val) {return val;}
   constexpr meterPerSecond<OMNI_LITTERAL_FLOATING> operator""_mPers(long double val) {return val;}
   constexpr kilometerPerHour<OMNI_LITTERAL_FLOATING> operator"" _kmPerh(long double val) {return val;}
@@ -108,6 +115,7 @@ namespace omni
 
   constexpr centimeter3<OMNI_LITTERAL_INTEGER> operator"" _cm3(unsigned long long int val) {return val;}
   constexpr liter<OMNI_LITTERAL_INTEGER> operator"" _L(unsigned long long int val) {return val;}
+  constexpr hertz<OMNI_LITTERAL_INTEGER> operator"" _Hz(unsigned long long int val) {return val;}
   constexpr perMinute<OMNI_LITTERAL_INTEGER> operator"" _PerMin(unsigned long long int val) {return val;}
   constexpr meterPerSecond<OMNI_LITTERAL_INTEGER> operator""_mPers(unsigned long long int val) {return val;}
   constexpr kilometerPerHour<OMNI_LITTERAL_INTEGER> operator"" _kmPerh(unsigned long long int val) {return val;}
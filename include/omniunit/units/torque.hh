@@ -35,7 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef OMNIUNIT_TORQUE_HH_
 #define OMNIUNIT_TORQUE_HH_
 
-#include "../omniunit.hh"
+#include "../core/Unit.hh"
 #include "moment_of_force.hh"
 
 
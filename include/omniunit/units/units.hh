@@ -35,7 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef UNITS_HH_
 #define UNITS_HH_
 
-#include "../omniunit.hh"
+#include "../core/Unit.hh"
 
 #include "angular_speed.hh"
 #include "dimensionless_angle.hh"
@@ -53,6 +53,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "temperature.hh"
 #include "torque.hh"
 
+#include "physical_constants.hh"
+
 #include "temporary.hh"
 
 #endif //UNITS_HH_
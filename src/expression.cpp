@@ -0,0 +1,50 @@
+#include "omniunit/omniunit.hh"
+#include "omniunit/unit_expression.hh"
+
+#include <iostream>
+#include <type_traits>
+
+// C++20 tests of unit_expression.hh : strings as template parameters need -std=c++20
+
+static_assert(std::is_same<omni::unit_t<"kg*m/s^2">, decltype(omni::kilogram<>() * omni::meter<>() / omni::pow<2>(omni::second<>()))>::value, "product, quotient and exponent");
+static_assert(std::is_same<omni::unit_t<"kg.m.s^-2">::dim, omni::newton<>::dim>::value, "negative exponent");
+static_assert(std::is_same<omni::unit_t<"N m">, omni::unit_t<"N\xC2\xB7m">>::value, "products with a space or a middle dot");
+static_assert(std::is_same<omni::unit_t<"m\xC2\xB2">, omni::unit_t<"m^2">>::value, "superscript exponent");
+static_assert(std::is_same<omni::unit_t<"(m/s)^2">, decltype(omni::pow<2>(omni::meter<>() / omni::second<>()))>::value, "parentheses");
+static_assert(std::is_same<omni::unit_t<"1/s">, decltype(1. / omni::second<>())>::value, "one as numerator");
+static_assert(std::is_same<omni::unit_t<"km", float>, omni::kilometer<float>>::value, "Rep of the expression");
+
+// prefixed symbols are the prefixed types of the headers
+static_assert(std::is_same<omni::unit_t<"mm">, omni::millimeter<>>::value, "mm");
+static_assert(std::is_same<omni::unit_t<"\xC2\xB5s">, omni::microsecond<>>::value, "micro sign");
+static_assert(std::is_same<omni::unit_t<"mg">, omni::milligram<>>::value, "mg");
+static_assert(std::is_same<omni::unit_t<"cg">, omni::centigram<>>::value, "cg");
+static_assert(std::is_same<omni::unit_t<"dg">, omni::decigram<>>::value, "dg");
+static_assert(std::is_same<omni::unit_t<"hPa">, omni::hectopascal<>>::value, "hPa");
+static_assert(std::is_same<omni::unit_t<"mbar">, omni::millibar<>>::value, "mbar");
+static_assert(std::is_same<omni::unit_t<"dbar">, omni::decibar<>>::value, "dbar");
+static_assert(std::is_same<omni::unit_t<"kWh">, omni::kilowattHour<>>::value, "kWh");
+static_assert(std::is_same<omni::unit_t<"kbar">::dim, omni::bar<>::dim>::value && omni::unit_t<"kbar">::period::value > 99999999. && omni::unit_t<"kbar">::period::value < 100000001., "prefixes without a named type multiply the period");
+
+static_assert(omni::meterPerSecond<>(omni::unit_t<"km/h">(36.)).count() > 9.999999 && omni::meterPerSecond<>(omni::unit_t<"km/h">(36.)).count() < 10.000001, "folded conversion");
+
+
+int main()
+{
+  int wrong = 0;
+
+  omni::unit_t<"kW"> heater(2.);
+  omni::unit_t<"min"> duration(30.);
+  omni::joule<> energy = heater * duration;
+  bool a = energy.count() > 3599999.999 && energy.count() < 3600000.001;
+  std::cout << "TEST 1  " << std::boolalpha << a << "  " << energy << "\n";
+  wrong += a ? 0 : 1;
+
+  omni::unit_t<"hPa"> pressure = omni::unit_t<"mbar">(1013.25);
+  bool b = pressure.count() > 1013.2499 && pressure.count() < 1013.2501;
+  std::cout << "TEST 2  " << std::boolalpha << b << "  " << pressure << "\n";
+  wrong += b ? 0 : 1;
+
+  std::cout << "nb de faux : " << wrong << "\n";
+  return wrong;
+}
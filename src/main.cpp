@@ -2,12 +2,25 @@
 
 #include "omniunit/omniunit.hh"
 #include "omniunit/chronoscale.hh"
+#include "omniunit/calculus.hh"
+#include "omniunit/linalg.hh"
+#include "omniunit/reduce.hh"
+#include "omniunit/parallel.hh"
+#include "omniunit/atomic.hh"
+#include "omniunit/sharded.hh"
+#include "omniunit/queue.hh"
+#include "omniunit/batch.hh"
+#if __has_include(<Eigen/Core>)
+#include "omniunit/eigen.hh"
+#endif
 #include "test.hh"
 
 #include <iostream>
 #include <thread>
 #include <typeinfo>
 #include <iomanip>
+#include <cstdlib>
+#include <cstring>
 
 
 #if OMNI_TRUE_ZERO == true
@@ -135,6 +148,96 @@ void show(int test, T const& var1, double ref = 0)
     faux::value++;
 }
 
+// compile-time checks : these fold with any compiler, not only with GCC builtins
+
+constexpr bool same_value(double a, double b)
+{
+  return a <= b && a >= b;
+}
+
+//largest distance in ulps between results and references, 0 for the same values (NaN included)
+double max_ulp(std::vector<double> const& results, std::vector<double> const& references)
+{
+  double worst = 0.;
+  for(std::size_t i = 0; i < results.size(); i++)
+  {
+    double a = results[i];
+    double b = references[i];
+    if(same_value(a, b) || (std::isnan(a) && std::isnan(b)))
+      continue;
+    if(std::isnan(a) || std::isnan(b) || std::isinf(a) || std::isinf(b) || std::signbit(a) != std::signbit(b))
+      return std::numeric_limits<double>::infinity();
+    std::int64_t bitsA = 0;
+    std::int64_t bitsB = 0;
+    std::memcpy(&bitsA, &a, sizeof(a));
+    std::memcpy(&bitsB, &b, sizeof(b));
+    worst = std::max(worst, std::fabs(static_cast<double>(bitsA - bitsB)));
+  }
+  return worst;
+}
+
+static_assert(same_value(omni::math::sqrt(2.), 1.4142135623730951), "constexpr sqrt");
+static_assert(same_value(omni::math::nroot(1000., 3), 10.), "constexpr nroot");
+static_assert(same_value(omni::math::nroot(-8., 3), -2.), "constexpr odd root of a negative value");
+static_assert(same_value(omni::math::log10(1e-9), -9.), "constexpr log10");
+static_assert(same_value(omni::math::pow(-1.5, 3), -3.375), "constexpr pow");
+static_assert(omni::math::sqrt(2.f) > 1.414213f && omni::math::sqrt(2.f) < 1.414214f, "constexpr sqrt (float)");
+static_assert(omni::math::nroot(27.f, 3) > 2.99999f && omni::math::nroot(27.f, 3) < 3.00001f, "constexpr nroot (float)");
+static_assert(same_value(omni::Conversion<omni::Kilometer, omni::Millimeter>::num, 1e6), "folded conversion factor");
+static_assert(same_value(omni::Ratio_times_Ratio<omni::yotta, omni::zepto>::type::num, 1e3) && same_value(omni::Ratio_times_Ratio<omni::yotta, omni::zepto>::type::den, 1.), "exact prefix products");
+static_assert(same_value(omni::Ratio_power<omni::kilo, -3>::type::den, 1e9) && omni::Ratio_power<omni::kilo, -3>::type::exact, "exact prefix powers");
+static_assert(!omni::Ratio_times_Ratio<omni::yotta, omni::yotta>::type::exact && !omni::pi::exact, "ratios above 2^53 are rounded");
+static_assert(same_value(omni::Conversion<omni::Celsius, omni::Kelvin>::offset, 273.15), "folded conversion offset");
+static_assert(same_value(omni::pow<3>(omni::Meter(2)).count(), 8.), "folded pow<>()");
+static_assert(same_value(omni::sqrt(omni::pow<2>(omni::Kilometer(3))).count(), 3.), "folded nroot<>()");
+static_assert(same_value(omni::Ratio_root<omni::Ratio_power<omni::kilo, 3>::type, 3>::type::value, 1000.), "folded Ratio_root");
+static_assert(same_value(omni::unit_cast<omni::Meter>(omni::Kilometer(1.5)).count(), 1500.), "folded unit_cast");
+static_assert(std::is_same<std::common_type<omni::Kilometer, omni::Millimeter>::type::period, omni::milli>::value, "folded common period");
+static_assert(same_value(omni::getDeviation(3., omni::Law::Uniform), 3. / 1.7320508075688772), "folded getDeviation");
+static_assert(omni::unit_cast<omni::meter<std::int64_t>>(omni::millimeter<std::int64_t>(-1500)).count() == -1, "integer cast, toward zero");
+static_assert(omni::unit_cast<omni::meter<std::int64_t>>(omni::millimeter<std::int64_t>(-1500), omni::Rounding::Nearest).count() == -2, "integer cast, nearest");
+static_assert(omni::unit_cast<omni::meter<std::int64_t>>(omni::millimeter<std::int64_t>(-1500), omni::Rounding::Down).count() == -2, "integer cast, down");
+static_assert(omni::unit_cast<omni::meter<std::int64_t>>(omni::millimeter<std::int64_t>(1001), omni::Rounding::Up).count() == 2, "integer cast, up");
+static_assert(omni::unit_cast<omni::nanosecond<std::int64_t>>(omni::second<std::int64_t>(9223372036)).count() == 9223372036000000000, "exact integer cast");
+static_assert(omni::unit_cast<omni::kelvin<int>>(omni::celsius<int>(-300), omni::Rounding::Nearest).count() == -27, "integer cast with offset");
+#if OMNI_CHECK_INTEGER_OVERFLOW == false
+static_assert(omni::unit_cast<omni::millimeter<std::int16_t>>(omni::meter<std::int16_t>(40)).count() == -25536, "unchecked integer casts wrap around");
+#endif
+static_assert(omni::unit_cast<omni::millimeter<omni::saturating<std::int32_t>>>(omni::kilometer<omni::saturating<std::int32_t>>(5000)).count().value() == 2147483647, "saturating cast");
+static_assert(omni::unit_cast<omni::millimeter<omni::wrapping<std::int32_t>>>(omni::kilometer<omni::wrapping<std::int32_t>>(5000)).count().value() == 705032704, "wrapping cast");
+static_assert((omni::meter<omni::saturating<std::int8_t>>(100) + omni::meter<omni::saturating<std::int8_t>>(100)).count().value() == 127, "saturating sum");
+static_assert(omni::sqrt(omni::pow<2>(omni::meter<omni::checked<int>>(3))).count().value() == 3, "pow and nroot of Integer reps");
+static_assert(omni::pow<3>(omni::meter<omni::saturating<std::int16_t>>(100)).count().value() == 32767, "pow of Integer reps follows their policy");
+static_assert(same_value(static_cast<double>(omni::sqrt(omni::pow<2>(omni::meter<omni::half>(1.5))).count()), 1.5), "pow and nroot of 16 bits reps");
+static_assert(omni::meter<omni::checked<>>(1) == omni::millimeter<omni::checked<>>(1000), "checked comparison");
+static_assert(omni::half(65504.f).bits() == 0x7BFF && omni::half(65520.f).bits() == 0x7C00, "half rounding");
+static_assert(omni::bfloat16(1.f).bits() == 0x3F80, "bfloat16 encoding");
+static_assert(sizeof(omni::meter<omni::half>) == 2 * sizeof(omni::half), "16 bits storage");
+static_assert(std::is_same<decltype(omni::meter<omni::half>() + omni::millimeter<omni::half>())::rep, float>::value, "16 bits arithmetic in float");
+static_assert(std::is_same<omni::calculus::integral_t<omni::watt<>, omni::second<>>::dim, omni::joule<>::dim>::value, "power over time is an energy");
+static_assert(std::is_same<omni::calculus::derivative_t<omni::meter<>, omni::second<>>::dim, omni::Dimension<1,0,-1,0,0,0,0>>::value, "length over time is a speed");
+static_assert(std::is_convertible<omni::calculus::integral_t<omni::kilowatt<float>, omni::hour<int>>, omni::joule<>>::value, "integrals convert to their unit");
+static_assert(std::is_same<decltype(omni::calculus::trapezoid(std::declval<omni::watt<> const*>(), std::declval<omni::second<> const*>(), 2)), omni::calculus::integral_t<omni::watt<>, omni::second<>>>::value, "trapezoid of power over time");
+static_assert(std::is_same<decltype(omni::calculus::trapezoid(std::declval<omni::kilowatt<> const*>(), 2, omni::minute<>())), omni::calculus::integral_t<omni::kilowatt<>, omni::minute<>>>::value, "trapezoid along a constant step");
+static_assert(omni::dot(omni::Vec3<omni::meter<>>(omni::meter<>(1), omni::meter<>(2), omni::meter<>(3)), omni::Vec3<omni::newton<>>(omni::newton<>(2), omni::newton<>(0), omni::newton<>(1))) == omni::joule<>(5), "dot of a length and a force");
+static_assert(sizeof(omni::Vec3<omni::meter<>>) == 32 && alignof(omni::Vec3<omni::meter<>>) == 32, "padded and aligned vectors");
+static_assert(std::is_same<decltype(omni::cross(omni::Vec3<omni::meter<>>(), omni::Vec3<omni::newton<>>()))::unit::dim, omni::joule<>::dim>::value, "cross of a length and a force");
+static_assert(std::is_same<decltype(omni::norm(omni::Vec3<omni::meter<>>())), omni::meter<>>::value, "norms are in the unit of the components");
+static_assert(std::is_same<decltype(omni::Mat2<omni::second<>>() * omni::Vec2<omni::meterPerSecond<>>())::unit::dim, omni::meter<>::dim>::value, "matrix times vector");
+static_assert(omni::cross(omni::Vec3<omni::meter<>>(omni::meter<>(1), omni::meter<>(0), omni::meter<>(0)), omni::Vec3<omni::newton<>>(omni::newton<>(0), omni::newton<>(2), omni::newton<>(0))) == omni::Vec3<omni::joule<>>(omni::joule<>(0), omni::joule<>(0), omni::joule<>(2)), "cross product");
+static_assert(omni::joule<>(omni::kilogram<>(1.) * omni::pow<2>(omni::constants::c<>)).count() >= 89875517873681764. && omni::joule<>(omni::kilogram<>(1.) * omni::pow<2>(omni::constants::c<>)).count() <= 89875517873681764., "mass energy equivalence folds");
+static_assert(std::is_same<decltype(omni::constants::k_B<>*omni::constants::N_A<>)::dim, std::remove_cv_t<decltype(omni::constants::R<>)>::dim>::value, "k_B.N_A is a molar gas constant");
+static_assert(omni::constants::G<>.absolute() > 0. && omni::constants::h<>.absolute() <= 0., "measured constants carry their uncertainty");
+static_assert(std::is_same<decltype(omni::parallel::transform_reduce(std::declval<std::vector<omni::meter<>>>(), std::declval<std::vector<omni::newton<>>>(), omni::joule<>(0.), std::plus<>(), std::multiplies<>())), omni::joule<>>::value, "parallel inner products keep their dimension");
+static_assert(sizeof(std::atomic<omni::joule<>>) == sizeof(double) && std::atomic<omni::joule<>>::is_always_lock_free, "atomic units are a single lock-free word");
+static_assert(std::is_same<omni::sharded_accumulator<omni::millisecond<>, true>::variance_type::dim, omni::Dimension<0,0,2,0,0,0,0>>::value, "variances are in squared units");
+static_assert(std::is_same<decltype(std::declval<omni::mpsc_queue<omni::millibar<float>>&>().pop(std::declval<omni::second<>*>(), std::declval<omni::hectopascal<>*>(), 1)), std::size_t>::value, "samples pop into any unit of their dimension");
+#if __has_include(<Eigen/Core>)
+static_assert(std::is_same<decltype((std::declval<Eigen::Matrix<omni::meter<>, 4, 4>>() * std::declval<Eigen::Matrix<omni::newton<>, 4, 4>>()).eval())::Scalar::dim, omni::Energy>::value, "small fixed size products of unit matrices");
+static_assert(std::is_same<decltype(std::declval<omni::UnitMatrix<omni::meter<>, Eigen::Dynamic, Eigen::Dynamic>>() * std::declval<omni::UnitMatrix<omni::newton<>, Eigen::Dynamic, Eigen::Dynamic>>())::unit::dim, omni::Energy>::value, "products of matrices of counts");
+#endif
+
+
 int main()
 {
   typedef omni::Unit<omni::Dimension<0,0,0,0,0,0,0>, float, omni::deci, omni::E1> scalar;
@@ -297,6 +400,295 @@ int main()
   auto var34 = temp34 + temp34;
   show(34, var34, VAR34);
 
+
+
+  omni::VirtualClock clock;
+  omni::ScalableTimer flow(2., clock);
+  flow.start();
+  clock.advance(omni::Millisecond(100));
+  flow.setRate(0.5);
+  clock.advance(omni::Millisecond(100));
+  flow.setRate(0.);
+  clock.advance(omni::Millisecond(100));
+  show(35, flow.get<omni::Millisecond>(), 250);
+
+  omni::Countdown countdown(omni::Millisecond(30), clock);
+  countdown.start();
+  int fired = 0;
+  clock.schedule(omni::Millisecond(20), [&fired](){fired = fired * 10 + 2;});
+  clock.schedule(omni::Millisecond(10), [&fired](){fired = fired * 10 + 1;});
+  clock.advance(omni::Millisecond(25));
+  show(36, fired, 12);
+  show(37, countdown.get<omni::Millisecond>(), 5);
+
+  omni::ConcurrentTimer shared(clock);
+  shared.start();
+  clock.advance(omni::Millisecond(10));
+  shared.pause();
+  clock.advance(omni::Millisecond(10));
+  shared += omni::Millisecond(1);
+  show(38, shared.get<omni::Millisecond>(), 11);
+
+  omni::RateMeter meter(omni::Second(10), omni::Second(5), clock);
+  meter.mark(120);
+  clock.advance(omni::Second(2));
+  show(39, meter.windowed<omni::PerMinute>(), 3600);
+
+  std::vector<omni::Countdown> countdowns;
+  countdowns.emplace_back(omni::Millisecond(10), clock);
+  countdowns.emplace_back(omni::Millisecond(4), clock);
+  clock.advance(omni::Millisecond(6));
+  show(40, omni::Countdown::wait_any<omni::Millisecond>(countdowns).second, 2);
+
+  show(41, static_cast<double>(omni::pow<3>(omni::meter<float>(2.f)).count()), 8);
+  show(42, static_cast<double>(omni::nroot<3>(omni::pow<3>(omni::meter<float>(3.f))).count()), 3);
+  show(43, omni::pow<2>(omni::meter<omni::checked<int>>(3)).count().value(), 9);
+  show(44, static_cast<double>(omni::pow<2>(omni::meter<omni::half>(1.5)).count()), 2.25);
+  show(45, static_cast<double>(omni::nroot<3>(omni::pow<3>(omni::meter<omni::bfloat16>(2.))).count()), 2);
+
+#if __has_include(<Eigen/Core>)
+  Eigen::Matrix<omni::meter<>, 4, 4> smallMeters = Eigen::Matrix<omni::meter<>, 4, 4>::Constant(omni::meter<>(2.));
+  Eigen::Matrix<omni::newton<>, 4, 4> smallNewtons = Eigen::Matrix<omni::newton<>, 4, 4>::Constant(omni::newton<>(3.));
+  show(46, (smallMeters * smallNewtons).eval()(3, 3), 24);
+  Eigen::Matrix<omni::meter<>, 30, 30> meters = Eigen::Matrix<omni::meter<>, 30, 30>::Constant(omni::meter<>(2.));
+  Eigen::Matrix<omni::newton<>, 30, 30> newtons = Eigen::Matrix<omni::newton<>, 30, 30>::Constant(omni::newton<>(3.));
+  show(47, meters.lazyProduct(newtons).eval()(29, 29), 180);
+  omni::UnitMatrix<omni::meter<>, 30, 30> meterCounts(Eigen::Matrix<double, 30, 30>::Constant(2.));
+  omni::UnitMatrix<omni::newton<>, 30, 30> newtonCounts(Eigen::Matrix<double, 30, 30>::Constant(3.));
+  show(48, (meterCounts * newtonCounts)(29, 29), 180);
+  omni::UnitMatrix<omni::meter<>, Eigen::Dynamic, Eigen::Dynamic> dynamicMeters(Eigen::MatrixXd::Constant(40, 40, 2.));
+  omni::UnitMatrix<omni::millinewton<>, Eigen::Dynamic, Eigen::Dynamic> dynamicNewtons(Eigen::MatrixXd::Constant(40, 40, 3.));
+  omni::UnitMatrix<omni::joule<>, Eigen::Dynamic, Eigen::Dynamic> dynamicJoules = dynamicMeters * dynamicNewtons;
+  show(49, dynamicJoules(39, 39), 0.24);
+  smallMeters = smallMeters * 2.;
+  show(114, std::abs(smallMeters(3, 3).count() - 4), 0);
+  Eigen::Matrix<omni::meter<>, Eigen::Dynamic, Eigen::Dynamic> dynamicLengths = Eigen::Matrix<omni::meter<>, Eigen::Dynamic, Eigen::Dynamic>::Constant(9, 9, omni::meter<>(2.));
+  show(115, std::abs(dynamicLengths.lazyProduct(dynamicLengths).eval()(8, 8).count() - 36), 0);
+#endif
+
+  show(50, omni::Meter(1.234).round(100), 1.23);
+  show(51, omni::Meter(-1.5).ceil(), -1);
+  show(52, static_cast<double>(omni::meter<float>(2.25f).floor(10).count()), 2.2);
+
+  omni::Countdown paused(omni::Millisecond(10), clock);
+  paused.start();
+  paused.pause();
+  int pausedWait = 0;
+  try { paused.wait(); } catch(std::logic_error const&) { pausedWait = 1; }
+  show(53, std::abs(pausedWait - 1), 0);
+  int emptyWait = 0;
+  try { omni::Countdown::wait_any(std::vector<omni::Countdown>()); } catch(std::invalid_argument const&) { emptyWait = 1; }
+  show(54, std::abs(emptyWait - 1), 0);
+  std::vector<omni::Countdown> pausedCountdowns;
+  pausedCountdowns.emplace_back(omni::Millisecond(10), clock);
+  pausedCountdowns.emplace_back(omni::Millisecond(4), clock);
+  for(omni::Countdown& item : pausedCountdowns)
+    item.start();
+  clock.advance(omni::Millisecond(6));
+  for(omni::Countdown& item : pausedCountdowns)
+    item.pause();
+  show(55, omni::Countdown::wait_any<omni::Millisecond>(pausedCountdowns).second, 2);
+  pausedCountdowns.erase(pausedCountdowns.begin() + 1);
+  int pausedWaitAny = 0;
+  try { omni::Countdown::wait_any(pausedCountdowns); } catch(std::logic_error const&) { pausedWaitAny = 1; }
+  show(56, std::abs(pausedWaitAny - 1), 0);
+
+  for(int i = 0; i < 100; i++)
+  {
+    omni::RateMeter shortLived(omni::Second(10), omni::Second(5), clock);
+    shortLived.mark(static_cast<unsigned long long>(i));
+  }
+  omni::RateMeter lastMeter(omni::Second(10), omni::Second(5), clock);
+  lastMeter.mark(60);
+  clock.advance(omni::Second(1));
+  show(57, lastMeter.instant<omni::Hertz>(), 60);
+
+  omni::parallel::ThreadPool pool(4);
+  std::vector<omni::joule<>> energies(100000, omni::joule<>(0.5));
+  show(58, omni::sum(energies, omni::Summation::Neumaier, pool), 50000);
+  show(59, same_value(omni::sum(energies, omni::Summation::Pairwise, pool).count(), omni::sum(energies, omni::Summation::Pairwise).count()) ? 0 : 1, 0);
+  std::vector<int> counts(100000, 2);
+  show(60, omni::reduce(counts, 0, std::plus<>()), 200000);
+
+  std::vector<omni::watt<>> squares{omni::watt<>(0), omni::watt<>(0.25), omni::watt<>(1), omni::watt<>(2.25), omni::watt<>(4)};
+  show(61, omni::joule<>(omni::calculus::simpson(squares.data(), squares.size(), omni::second<>(0.5))), 8. / 3.);
+  std::vector<omni::kilowatt<>> heater(3, omni::kilowatt<>(1));
+  show(62, omni::joule<>(omni::calculus::simpson(heater.data(), heater.size(), omni::minute<>(1))), 120000);
+  std::vector<omni::second<>> irregular{omni::second<>(0), omni::second<>(0.5), omni::second<>(1.5), omni::second<>(2)};
+  std::vector<omni::watt<>> sampled{omni::watt<>(0), omni::watt<>(0.25), omni::watt<>(2.25), omni::watt<>(4)};
+  show(63, omni::joule<>(omni::calculus::simpson(sampled.data(), irregular.data(), sampled.size())), 8. / 3.);
+  show(88, omni::joule<>(omni::calculus::trapezoid(sampled.data(), irregular.data(), sampled.size())), 2.875);
+  show(89, omni::joule<>(omni::calculus::trapezoid(squares.data(), squares.size(), omni::second<>(0.5))), 2.75);
+  omni::joule<> running[5];
+  omni::calculus::cumulative_trapezoid(squares.data(), squares.size(), omni::second<>(0.5), running);
+  show(90, running[2], 0.375);
+  show(91, running[4], 2.75);
+  std::vector<omni::meter<>> track{omni::meter<>(0), omni::meter<>(0.25), omni::meter<>(2.25), omni::meter<>(4)};
+  omni::calculus::derivative_t<omni::meter<>, omni::second<>> speeds[4];
+  omni::calculus::derivative(track.data(), irregular.data(), track.size(), speeds);
+  show(92, speeds[0], 0.5);
+  show(93, speeds[1], 1);
+  show(94, speeds[2], 3);
+
+  omni::Vec3<omni::meter<>> arm(omni::meter<>(0), omni::meter<>(3), omni::meter<>(4));
+  omni::Vec3<omni::newton<>> pull(omni::newton<>(1), omni::newton<>(0), omni::newton<>(0));
+  show(95, omni::cross(arm, pull)[1], 4);
+  show(96, omni::cross(arm, pull)[2], -3);
+  show(97, omni::norm(arm), 5);
+  omni::Mat2<omni::second<>> durations(omni::second<>(1), omni::second<>(2), omni::second<>(3), omni::second<>(4));
+  omni::Vec2<omni::meterPerSecond<>> velocity(omni::meterPerSecond<>(1), omni::meterPerSecond<>(0.5));
+  show(98, (durations * velocity)[0], 2);
+  show(99, (durations * velocity)[1], 5);
+  omni::VecArray<omni::meter<>, 3> arms;
+  omni::VecArray<omni::newton<>, 3> pulls;
+  arms.push_back(arm);
+  arms.push_back(omni::Vec3<omni::meter<>>(omni::meter<>(1), omni::meter<>(2), omni::meter<>(2)));
+  pulls.push_back(pull);
+  pulls.push_back(omni::Vec3<omni::newton<>>(omni::newton<>(0), omni::newton<>(0), omni::newton<>(2)));
+  std::vector<omni::joule<>> works(2);
+  omni::batch::dot(arms, pulls, works);
+  show(100, works[1], 4);
+  std::vector<omni::meter<>> reaches(2);
+  omni::batch::norm(arms, reaches);
+  show(101, reaches[1], 3);
+  omni::VecArray<omni::joule<>, 3> torques;
+  omni::batch::cross(arms, pulls, torques);
+  show(102, torques[0][2], -3);
+  show(103, torques[1][0], 4);
+  omni::VecArray<omni::meter<>, 3> scaled;
+  omni::batch::transform(omni::Mat3<omni::value<>>::identity() * 2, arms, scaled);
+  show(104, scaled[1][2], 4);
+
+  std::vector<omni::radian<>> angles;
+  std::vector<omni::radian<>> largeAngles;
+  std::vector<omni::degree<>> degrees;
+  std::vector<omni::value<>> exponents;
+  std::vector<omni::value<>> logarithms;
+  for(int i = -2000; i <= 2000; i++)
+  {
+    angles.emplace_back(i / 200.);
+    largeAngles.emplace_back(1e3 + (i + 2000) * 199.75);
+    degrees.emplace_back(i * 1.8);
+    exponents.emplace_back(i * 0.35);
+    logarithms.emplace_back(std::pow(10., i * 0.15));
+  }
+  auto references = [](auto const& units, auto function)
+  {
+    std::vector<double> result;
+    for(auto const& unit : units)
+      result.push_back(function(unit));
+    return result;
+  };
+  std::vector<double> results(angles.size());
+  omni::batch::sin(angles, results);
+  show(105, max_ulp(results, references(angles, [](omni::radian<> x) {return std::sin(x.count());})), 2);
+  omni::batch::cos(angles, results);
+  show(106, max_ulp(results, references(angles, [](omni::radian<> x) {return std::cos(x.count());})), 2);
+  omni::batch::sin(degrees, results);
+  show(107, max_ulp(results, references(degrees, [](omni::degree<> x) {return omni::sin(x);})), 2);
+  omni::batch::sin(largeAngles, results);
+  show(108, max_ulp(results, references(largeAngles, [](omni::radian<> x) {return std::sin(x.count());})), 3);
+  omni::batch::cos(largeAngles, results);
+  show(109, max_ulp(results, references(largeAngles, [](omni::radian<> x) {return std::cos(x.count());})), 3);
+  std::vector<omni::radian<>> zeros;
+  for(int n = -509000; n <= 509000; n += 2545)
+    zeros.emplace_back(n * 1.5707963267948966);
+  std::vector<double> zeroResults(zeros.size());
+  omni::batch::sin(zeros, zeroResults);
+  double zeroUlps = max_ulp(zeroResults, references(zeros, [](omni::radian<> x) {return std::sin(x.count());}));
+  omni::batch::cos(zeros, zeroResults);
+  zeroUlps = std::max(zeroUlps, max_ulp(zeroResults, references(zeros, [](omni::radian<> x) {return std::cos(x.count());})));
+  show(110, zeroUlps, 2);
+  omni::batch::exp(exponents, results);
+  show(111, max_ulp(results, references(exponents, [](omni::value<> x) {return std::exp(x.count());})), 1);
+  omni::batch::log(logarithms, results);
+  show(112, max_ulp(results, references(logarithms, [](omni::value<> x) {return std::log(x.count());})), 1);
+  double const inf = std::numeric_limits<double>::infinity();
+  double const nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<omni::value<>> specials{omni::value<>(inf), omni::value<>(-inf), omni::value<>(nan), omni::value<>(0.), omni::value<>(-1.), omni::value<>(1e6), omni::value<>(1e22), omni::value<>(800.)};
+  std::vector<double> specialResults(specials.size());
+  double specialUlps = 0.;
+  omni::batch::sin(specials, specialResults);
+  specialUlps += max_ulp(specialResults, references(specials, [](omni::value<> x) {return std::sin(x.count());}));
+  omni::batch::cos(specials, specialResults);
+  specialUlps += max_ulp(specialResults, references(specials, [](omni::value<> x) {return std::cos(x.count());}));
+  omni::batch::exp(specials, specialResults);
+  specialUlps += max_ulp(specialResults, references(specials, [](omni::value<> x) {return std::exp(x.count());}));
+  omni::batch::log(specials, specialResults);
+  specialUlps += max_ulp(specialResults, references(specials, [](omni::value<> x) {return std::log(x.count());}));
+  show(113, specialUlps, 0);
+
+  show(64, omni::parallel::transform_reduce(energies, omni::joule<>(0), std::plus<>(), [](omni::joule<> e) {return e * 2;}, pool), 100000);
+  show(65, omni::parallel::reduce(counts, 0, std::plus<>(), pool), 200000);
+  int rethrown = 0;
+  try
+  {
+    omni::parallel::for_each(counts, [&counts](int& c) {if(&c == &counts[50000]) throw std::runtime_error("task");}, pool);
+  }
+  catch(std::runtime_error const& error)
+  {
+    rethrown = std::string(error.what()) == "task" ? 1 : 0;
+  }
+  show(66, std::abs(rethrown - 1), 0);
+  std::vector<int> nested(8, 0);
+  omni::parallel::for_each(nested, [&](int& n) {n = omni::parallel::reduce(counts, 0, std::plus<>(), pool);}, pool);
+  show(67, omni::reduce(nested, 0, std::plus<>()), 1600000);
+
+  omni::spsc_queue<omni::millibar<float>, omni::millisecond<std::int64_t>> ring(4);
+  omni::pascal_t<> pascals[4];
+  omni::second<> stamps[4];
+  for(std::int64_t i = 0; i < 3; i++)
+    ring.push(omni::millisecond<std::int64_t>(i), omni::millibar<float>(static_cast<float>(i)));
+  ring.pop(stamps, pascals, 2);
+  for(std::int64_t i = 3; i < 6; i++)
+    ring.push(omni::millisecond<std::int64_t>(i), omni::millibar<float>(static_cast<float>(i)));
+  show(68, ring.push(omni::millisecond<std::int64_t>(6), omni::millibar<float>(6.f)) ? 1 : 0, 0);
+  show(69, ring.pop(stamps, pascals, 4), 4);
+  show(70, pascals[3], 500);
+  show(71, stamps[3], 0.005);
+  omni::mpsc_queue<omni::millibar<float>> barometers(2);
+  barometers.push(omni::nanosecond<std::int64_t>(1), omni::millibar<float>(1013.25f));
+  barometers.push(omni::nanosecond<std::int64_t>(2), omni::millibar<float>(1000.f));
+  show(72, barometers.push(omni::nanosecond<std::int64_t>(3), omni::millibar<float>(990.f)) ? 1 : 0, 0);
+  omni::sample<omni::hectopascal<>, omni::second<>> reading;
+  barometers.pop(reading);
+  show(73, reading.value, 1013.25);
+
+  omni::sharded_accumulator<omni::meter<>, true> lengths;
+  auto addLengths = [&lengths](int first, int last) {for(int i = first; i <= last; i++) lengths += omni::meter<>(i);};
+  std::thread first(addLengths, 1, 3);
+  std::thread second(addLengths, 4, 5);
+  first.join();
+  second.join();
+  std::thread third(addLengths, 6, 6);
+  third.join();
+  show(74, lengths.sum(), 21);
+  show(75, lengths.count(), 6);
+  show(76, lengths.mean(), 3.5);
+  show(77, lengths.variance(), 35. / 12.);
+
+  std::atomic<omni::joule<>> stored(omni::joule<>(100));
+  show(78, stored.fetch_add(omni::kilojoule<>(2)), 100);
+  show(79, stored.load(), 2100);
+  std::atomic<omni::celsius<>> room(omni::celsius<>(20));
+  room.fetch_add(omni::kelvin<>(5));
+  omni::celsius<> heated(20);
+  heated += omni::kelvin<>(5);
+  show(80, room.load(), heated.count());
+  show(81, room.load(), 25);
+  omni::joule<> expected(0);
+  show(82, stored.compare_exchange_strong(expected, omni::kilojoule<>(1)) ? 1 : 0, 0);
+  show(83, expected, 2100);
+  show(84, stored.load(), 2100);
+
+  constexpr double cubeRoot = omni::math::nroot(-8., 3);
+  double negative = -8.;
+  show(85, same_value(omni::math::nroot(negative, 3), cubeRoot) ? 0 : 1, 0);
+  double thousand = 1000.;
+  show(86, same_value(omni::math::nroot(thousand, 3), 10.) ? 0 : 1, 0);
+  double power = 1e15;
+  show(87, same_value(omni::math::nroot(power, 5), 1000.) ? 0 : 1, 0);
+
   //constexpr scalar x(1);
   //constexpr scalar y(3);
   //constexpr scalar z = (x/y);